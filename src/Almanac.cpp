@@ -0,0 +1,102 @@
+#ifndef TSUKI_ALMANAC_CPP
+#define TSUKI_ALMANAC_CPP
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <vector>
+
+#include <HorizonScan.cpp>
+#include <LunarTrack.cpp>
+#include <MoonInfo.cpp>
+#include <Parallel.cpp>
+#include <TimeZone.cpp>
+
+// One local calendar day of the almanac. Times are UTC Julian days.
+struct AlmanacDay {
+    int year;
+    int month;
+    int day;
+    double midnightJD;
+    // Phase and illumination at local noon.
+    MoonPhase phase;
+    // First moonrise and moonset in [midnightJD, next midnight).
+    std::optional<double> riseJD;
+    std::optional<double> setJD;
+    // When a rise or set is missing: AlwaysAbove or AlwaysBelow if the Moon is on the same
+    // side of the horizon at both midnights, as MoonInfo reports it; otherwise MayCross.
+    HorizonClass noEventClass = HorizonClass::MayCross;
+};
+
+// Daily phase, illumination, moonrise and moonset for `days` local days from year-month-day.
+// Days are split across `threads` threads (0 = one per hardware thread). Each thread scans its
+// days in blocks of BLOCK_DAYS with one LunarTrack and one continuous findHorizonCrossings
+// pass per block, so every altitude sample serves exactly one day instead of the three a
+// per-day MoonInfo (which scans +-1 day) would spend on it.
+inline std::vector<AlmanacDay> generateAlmanac(double latitude_deg, double longitude_deg, int year, int month, int day, int days,
+                                               unsigned threads = 0, HorizonScan horizon_scan = HorizonScan::Adaptive,
+                                               const TimeZone& time_zone = TimeZone::local()) {
+    constexpr int BLOCK_DAYS = 64;
+
+    // Day boundaries in time_zone: midnights[i] starts day i and midnights[days] ends the last.
+    std::vector<AlmanacDay> almanac(std::max(days, 0));
+    std::vector<double> midnights(almanac.size() + 1);
+    for (std::size_t i = 0; i < midnights.size(); ++i) {
+        int y = year;
+        int m = month;
+        int d = day + static_cast<int>(i);
+        midnights[i] = time_zone.localMidnightJD(y, m, d);
+        if (i < almanac.size()) {
+            almanac[i].year = y;
+            almanac[i].month = m;
+            almanac[i].day = d;
+            almanac[i].midnightJD = midnights[i];
+        }
+    }
+
+    parallelFor(static_cast<int>(almanac.size()), threads, [&](int first_day, int end_day) {
+        for (int block = first_day; block < end_day; block += BLOCK_DAYS) {
+            const int block_end = std::min(block + BLOCK_DAYS, end_day);
+            const double start_JD = midnights[block];
+            const double end_JD = midnights[block_end];
+
+            const LunarTrack track(start_JD, end_JD);
+            const ObserverGeometry observer = makeObserverGeometry(longitude_deg, latitude_deg);
+            auto altitude = [&](double JD) {
+                return getTopocentricAltitude(makeTopocentricEpoch(track.at(JD), JD), observer);
+            };
+            HorizonCrossings crossings = findHorizonCrossings(altitude, start_JD, end_JD, HORIZON_ALT_DEG, horizon_scan);
+
+            // Crossings come out in time order, so the first one landing in a day is its earliest.
+            auto assign = [&](const std::vector<double>& events, std::optional<double> AlmanacDay::*field) {
+                for (double JD : events) {
+                    auto next = std::upper_bound(midnights.begin() + block, midnights.begin() + block_end + 1, JD);
+                    std::size_t i = static_cast<std::size_t>(next - midnights.begin()) - 1;
+                    if (JD < end_JD && !(almanac[i].*field)) {
+                        almanac[i].*field = JD;
+                    }
+                }
+            };
+            assign(crossings.rises, &AlmanacDay::riseJD);
+            assign(crossings.sets, &AlmanacDay::setJD);
+
+            for (int i = block; i < block_end; ++i) {
+                AlmanacDay& entry = almanac[i];
+                entry.phase = getMoonPhase((midnights[i] + midnights[i + 1]) / 2.0);
+
+                if (!entry.riseJD || !entry.setJD) {
+                    double alt_at_midnight = altitude(midnights[i]);
+                    double alt_before_next_midnight = altitude(midnights[i + 1] - 0.0001);
+                    if (alt_at_midnight > HORIZON_ALT_DEG && alt_before_next_midnight > HORIZON_ALT_DEG) {
+                        entry.noEventClass = HorizonClass::AlwaysAbove;
+                    } else if (alt_at_midnight < HORIZON_ALT_DEG && alt_before_next_midnight < HORIZON_ALT_DEG) {
+                        entry.noEventClass = HorizonClass::AlwaysBelow;
+                    }
+                }
+            }
+        }
+    });
+    return almanac;
+}
+
+#endif
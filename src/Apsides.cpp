@@ -0,0 +1,86 @@
+#ifndef TSUKI_APSIDES_CPP
+#define TSUKI_APSIDES_CPP
+
+#include <cmath>
+#include <optional>
+#include <vector>
+
+#include <EphemerisFile.cpp>
+#include <PhaseEvents.cpp>
+#include <RootFinder.cpp>
+
+enum class Apsis {
+    Perigee,
+    Apogee
+};
+
+struct ApsisEvent {
+    Apsis apsis;
+    double JD;
+    // Earth-Moon distance in km.
+    double distance;
+    // The full moon within NEAR_FULL_MOON_DEG of elongation of this apsis (about a day), if
+    // any. A perigee with one is a supermoon, an apogee with one a micromoon.
+    std::optional<double> fullMoonJD;
+};
+
+// Mean anomalistic month and the mean perigee of 1999 December 22 (Meeus 50.1), used only to
+// place the search windows.
+constexpr double ANOMALISTIC_MONTH_DAYS = 27.55454989;
+constexpr double MEAN_PERIGEE_JD_1999 = 2451534.6698;
+// Solar perturbations move the true perigee up to ~2.5 days from the mean one, the apogee
+// much less; the window is wider than both.
+constexpr double APSIS_WINDOW_DAYS = 3.5;
+constexpr double NEAR_FULL_MOON_DEG = 13.0;
+
+// Rate of change of the Earth-Moon distance in km/day, from the same distance series as
+// every other position in the tree (through the ephemeris cache or file).
+inline double getLunarDistanceRate(double JD) {
+    constexpr double DERIVATIVE_STEP_JD = 0.01;
+    return (ephemerisLunarCoordinates(JD + DERIVATIVE_STEP_JD).radiusVector -
+            ephemerisLunarCoordinates(JD - DERIVATIVE_STEP_JD).radiusVector) / (2.0 * DERIVATIVE_STEP_JD);
+}
+
+// Every perigee and apogee in [start_JD, end_JD), in time order. Each apsis is looked for
+// only in a window around its mean time, where the distance rate is sampled twice a day
+// for the one sign change (- to + at perigee, + to - at apogee), refined with findRootBrent
+// to about a second.
+inline std::vector<ApsisEvent> findApsides(double start_JD, double end_JD) {
+    constexpr double SAMPLE_STEP_JD = 0.5;
+    const double TOLERANCE_JD = 1.0 / (24.0 * 60.0 * 60.0);
+
+    std::vector<ApsisEvent> events;
+    long long half_month = static_cast<long long>(std::floor((start_JD - MEAN_PERIGEE_JD_1999) / ANOMALISTIC_MONTH_DAYS * 2.0)) - 1;
+    for (;; ++half_month) {
+        double mean_JD = MEAN_PERIGEE_JD_1999 + ANOMALISTIC_MONTH_DAYS * static_cast<double>(half_month) / 2.0;
+        if (mean_JD - APSIS_WINDOW_DAYS >= end_JD) {
+            break;
+        }
+        Apsis apsis = half_month % 2 == 0 ? Apsis::Perigee : Apsis::Apogee;
+
+        double prev_JD = mean_JD - APSIS_WINDOW_DAYS;
+        double prev_rate = getLunarDistanceRate(prev_JD);
+        while (prev_JD < mean_JD + APSIS_WINDOW_DAYS) {
+            double current_JD = prev_JD + SAMPLE_STEP_JD;
+            double current_rate = getLunarDistanceRate(current_JD);
+            bool found = apsis == Apsis::Perigee ? prev_rate < 0.0 && current_rate >= 0.0 : prev_rate > 0.0 && current_rate <= 0.0;
+            if (found) {
+                double JD = findRootBrent(getLunarDistanceRate, prev_JD, current_JD, prev_rate, current_rate, TOLERANCE_JD);
+                if (JD >= start_JD && JD < end_JD) {
+                    LunarCoords moon = ephemerisLunarCoordinates(JD);
+                    ApsisEvent event{apsis, JD, moon.radiusVector, std::nullopt};
+                    if (180.0 - std::abs(getLunarElongation(moon, ephemerisSolarCoordinates(JD))) < NEAR_FULL_MOON_DEG) {
+                        event.fullMoonJD = solvePhaseEvent(JD, PrincipalPhase::FullMoon);
+                    }
+                    events.push_back(event);
+                }
+                break;
+            }
+            prev_JD = current_JD;
+            prev_rate = current_rate;
+        }
+    }
+    return events;
+}
+
+#endif
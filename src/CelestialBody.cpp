@@ -0,0 +1,139 @@
+#ifndef TSUKI_CELESTIAL_BODY_CPP
+#define TSUKI_CELESTIAL_BODY_CPP
+
+#include <array>
+#include <cmath>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include <HorizonScan.cpp>
+#include <LunarTrack.cpp>
+
+// Everything about an epoch that does not depend on the body: sidereal time, nutation and
+// obliquity. One SkyEpoch per sample is shared by every body a scan follows.
+struct SkyEpoch {
+    double JD;
+    double gmst;              // radians
+    double nutationLongitude; // degrees
+    double trueObliquity;     // radians
+};
+
+inline SkyEpoch makeSkyEpoch(double JD_utc) {
+    double delta_psi, delta_epsilon;
+    double mean_obliquity_deg = getObliquityAndNutation(getFundamentalArguments(JD_utc), delta_psi, delta_epsilon);
+    return SkyEpoch{JD_utc, degreesToRadians(getGMST(JD_utc)), delta_psi, degreesToRadians(mean_obliquity_deg + delta_epsilon)};
+}
+
+inline EquatorialCoords eclipticToApparentEquatorial(double ecliptic_longitude_deg, double ecliptic_latitude_deg, double distance_km, const SkyEpoch& sky) {
+    return eclipticToApparentEquatorial(ecliptic_longitude_deg, ecliptic_latitude_deg, distance_km, sky.nutationLongitude, sky.trueObliquity);
+}
+
+inline TopocentricEpoch makeTopocentricEpoch(const EquatorialCoords& body, const SkyEpoch& sky) {
+    double horizontal_parallax_rad = asin(EARTH_RADIUS_KM / body.distance);
+    return TopocentricEpoch{sky.gmst, body.rightAscension, sin(body.declination), cos(body.declination), sin(horizontal_parallax_rad)};
+}
+
+// Body positions: functors from a SkyEpoch to the apparent geocentric position. They are
+// template parameters of the solvers below, so the inner loop has no indirect calls.
+// NEEDS_NUTATION says whether the body reads the epoch's nutation and obliquity.
+
+constexpr double AU_KM = 149597870.7;
+
+struct SolarPosition {
+    static constexpr bool NEEDS_NUTATION = true;
+
+    // Geometric longitude from the ephemeris, corrected for annual aberration (20.4898" / R).
+    // The Sun's ecliptic latitude stays below 1" and is taken as zero.
+    EquatorialCoords operator()(const SkyEpoch& sky) const {
+        SolarCoords sun = ephemerisSolarCoordinates(sky.JD);
+        double aberration_deg = -20.4898 / 3600.0 / sun.radiusVector;
+        return eclipticToApparentEquatorial(sun.eclipticLongitude + aberration_deg, 0.0, sun.radiusVector * AU_KM, sky);
+    }
+};
+
+struct LunarPosition {
+    static constexpr bool NEEDS_NUTATION = true;
+
+    EquatorialCoords operator()(const SkyEpoch& sky) const {
+        LunarCoords moon = ephemerisLunarCoordinates(sky.JD);
+        return eclipticToApparentEquatorial(moon.eclipticLongitude, moon.eclipticLatitude, moon.radiusVector, sky);
+    }
+};
+
+// Interpolated from a LunarTrack, whose samples already include nutation.
+struct LunarTrackPosition {
+    static constexpr bool NEEDS_NUTATION = false;
+
+    const LunarTrack* track;
+
+    EquatorialCoords operator()(const SkyEpoch& sky) const {
+        return track->at(sky.JD);
+    }
+};
+
+// Standard altitudes of the Sun's centre: sunrise/sunset (refraction plus semidiameter) and
+// the three twilights.
+constexpr double SUNRISE_ALT_DEG = -0.8333;
+constexpr double CIVIL_TWILIGHT_ALT_DEG = -6.0;
+constexpr double NAUTICAL_TWILIGHT_ALT_DEG = -12.0;
+constexpr double ASTRONOMICAL_TWILIGHT_ALT_DEG = -18.0;
+
+// Earth rotation plus the Sun's motion in declination, with headroom.
+constexpr double MAX_SOLAR_ALTITUDE_RATE_DEG_PER_DAY = 15.2 * 24.0;
+
+// Horizon crossings for several bodies over one shared set of samples. Each sample builds a
+// single SkyEpoch (nutation only if some body needs it) and evaluates each body once, however
+// many targets refer to it; HorizonTarget::source indexes `bodies` in order. Refining a
+// crossing evaluates only the body it belongs to. The adaptive step uses the largest of the
+// bodies' altitude rates, max_rate_deg_per_day.
+template <typename... Bodies>
+std::vector<HorizonCrossings> findBodyHorizonCrossings(const ObserverSite& observer, double start_JD, double end_JD,
+                                                       std::span<const HorizonTarget> targets, HorizonScan scan,
+                                                       double max_rate_deg_per_day, const Bodies&... bodies) {
+    auto sky_epoch = [](double JD, bool nutation) {
+        return nutation ? makeSkyEpoch(JD) : SkyEpoch{JD, degreesToRadians(getGMST(JD)), 0.0, 0.0};
+    };
+    auto altitudes = [&](double JD, double* out, std::size_t only) {
+        std::size_t source = 0;
+        if (only == ALL_SOURCES) {
+            SkyEpoch sky = sky_epoch(JD, (Bodies::NEEDS_NUTATION || ...));
+            ((out[source++] = getTopocentricAltitude(makeTopocentricEpoch(bodies(sky), sky), observer.geometry)), ...);
+            return;
+        }
+        // Refinement: just the bracketed body, with nutation only if it needs it.
+        auto refine = [&](const auto& body) {
+            if (source++ == only) {
+                SkyEpoch sky = sky_epoch(JD, std::decay_t<decltype(body)>::NEEDS_NUTATION);
+                out[only] = getTopocentricAltitude(makeTopocentricEpoch(body(sky), sky), observer.geometry);
+            }
+        };
+        (refine(bodies), ...);
+    };
+    return findHorizonCrossings(altitudes, sizeof...(Bodies), start_JD, end_JD, targets, scan, max_rate_deg_per_day);
+}
+
+enum class SolarEvent {
+    Sunrise,
+    CivilTwilight,
+    NauticalTwilight,
+    AstronomicalTwilight
+};
+
+// Sunrise/sunset and civil, nautical and astronomical dawn/dusk in [start_JD, end_JD] from a
+// single scan of the Sun, indexed by SolarEvent: `rises` are sunrises and dawns, `sets`
+// sunsets and dusks.
+inline std::array<HorizonCrossings, 4> findSolarEvents(double longitude_deg, double latitude_deg, double start_JD, double end_JD,
+                                                       HorizonScan scan = HorizonScan::Adaptive) {
+    const HorizonTarget targets[] = {
+        {0, SUNRISE_ALT_DEG},
+        {0, CIVIL_TWILIGHT_ALT_DEG},
+        {0, NAUTICAL_TWILIGHT_ALT_DEG},
+        {0, ASTRONOMICAL_TWILIGHT_ALT_DEG},
+    };
+    std::vector<HorizonCrossings> crossings = findBodyHorizonCrossings(makeObserverSite(latitude_deg, longitude_deg), start_JD, end_JD,
+                                                                       targets, scan, MAX_SOLAR_ALTITUDE_RATE_DEG_PER_DAY, SolarPosition{});
+    return {std::move(crossings[0]), std::move(crossings[1]), std::move(crossings[2]), std::move(crossings[3])};
+}
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef TSUKI_ECLIPSES_CPP
+#define TSUKI_ECLIPSES_CPP
+
+#include <cmath>
+#include <vector>
+
+#include <EphemerisFile.cpp>
+#include <PhaseEvents.cpp>
+#include <RootFinder.cpp>
+
+enum class LunarEclipseType {
+    Penumbral,
+    Partial,
+    Total
+};
+
+struct LunarEclipse {
+    LunarEclipseType type;
+    // Instant of least distance between the Moon and the shadow axis.
+    double greatestJD;
+    // Fraction of the Moon's diameter inside the umbra (negative for penumbral eclipses) and
+    // inside the penumbra, at greatest eclipse.
+    double umbralMagnitude;
+    double penumbralMagnitude;
+};
+
+// Shadow geometry at one instant, all angles in degrees as seen from the Earth's centre.
+struct EclipseGeometry {
+    // Angular distance from the Moon's centre to the shadow axis (the anti-Sun).
+    double separation;
+    double moonSemidiameter;
+    double umbraRadius;
+    double penumbraRadius;
+};
+
+inline EclipseGeometry getEclipseGeometry(double JD) {
+    // Shadow radii are enlarged by 1/50 for the atmosphere (Chauvenet) and the lunar parallax
+    // is scaled down for the Earth's oblateness, as in the Five Millennium Canon.
+    constexpr double ATMOSPHERE_ENLARGEMENT = 1.02;
+    constexpr double OBLATENESS_FACTOR = 0.998340;
+    constexpr double SOLAR_PARALLAX_AU_DEG = 8.794 / 3600.0;
+    constexpr double SOLAR_SEMIDIAMETER_AU_DEG = 959.63 / 3600.0;
+    constexpr double MOON_SEMIDIAMETER_KM_DEG = 358473400.0 / 3600.0;
+
+    LunarCoords moon = ephemerisLunarCoordinates(JD);
+    SolarCoords sun = ephemerisSolarCoordinates(JD);
+
+    double delta_longitude_rad = degreesToRadians(180.0 - std::abs(getLunarElongation(moon, sun)));
+    double latitude_rad = degreesToRadians(moon.eclipticLatitude);
+
+    double moon_parallax = OBLATENESS_FACTOR * radiansToDegrees(asin(EARTH_RADIUS_KM / moon.radiusVector));
+    double sun_parallax = SOLAR_PARALLAX_AU_DEG / sun.radiusVector;
+    double sun_semidiameter = SOLAR_SEMIDIAMETER_AU_DEG / sun.radiusVector;
+
+    EclipseGeometry geometry;
+    geometry.separation = radiansToDegrees(acos(cos(latitude_rad) * cos(delta_longitude_rad)));
+    geometry.moonSemidiameter = MOON_SEMIDIAMETER_KM_DEG / moon.radiusVector;
+    geometry.umbraRadius = ATMOSPHERE_ENLARGEMENT * (moon_parallax + sun_parallax - sun_semidiameter);
+    geometry.penumbraRadius = ATMOSPHERE_ENLARGEMENT * (moon_parallax + sun_parallax + sun_semidiameter);
+    return geometry;
+}
+
+// Every lunar eclipse whose greatest eclipse falls in [start_JD, end_JD), in time order.
+// Lunations are filtered at their mean full moon by the Moon's argument of latitude: with
+// |sin F| > 0.36 the Moon is too far from a node for any eclipse (Meeus ch. 54), which
+// rejects about three quarters of them for one evaluation of the fundamental arguments. The
+// rest get the exact full moon from solvePhaseEvent and the least Moon-shadow separation
+// from findMaximumBrent within six hours of it.
+inline std::vector<LunarEclipse> findLunarEclipses(double start_JD, double end_JD) {
+    constexpr double NODE_FILTER_SIN_F = 0.36;
+    constexpr double GREATEST_ECLIPSE_WINDOW_JD = 0.25;
+    const double TOLERANCE_JD = 1.0 / (24.0 * 60.0 * 60.0);
+
+    std::vector<LunarEclipse> eclipses;
+    long long lunation = static_cast<long long>(std::floor((start_JD - MEAN_NEW_MOON_JD_2000) / SYNODIC_MONTH_DAYS)) - 1;
+    for (;; ++lunation) {
+        double mean_full_JD = MEAN_NEW_MOON_JD_2000 + SYNODIC_MONTH_DAYS * (static_cast<double>(lunation) + 0.5);
+        if (mean_full_JD - 1.0 >= end_JD) {
+            break;
+        }
+        if (std::abs(sin(getFundamentalArguments(mean_full_JD).argumentOfLatitude)) > NODE_FILTER_SIN_F) {
+            continue;
+        }
+
+        double full_JD = solvePhaseEvent(mean_full_JD, PrincipalPhase::FullMoon);
+        auto negative_separation = [](double JD) {
+            return -getEclipseGeometry(JD).separation;
+        };
+        double least;
+        double greatest_JD = findMaximumBrent(negative_separation, full_JD - GREATEST_ECLIPSE_WINDOW_JD, full_JD,
+                                              full_JD + GREATEST_ECLIPSE_WINDOW_JD, negative_separation(full_JD), TOLERANCE_JD, least);
+        if (greatest_JD < start_JD || greatest_JD >= end_JD) {
+            continue;
+        }
+
+        EclipseGeometry geometry = getEclipseGeometry(greatest_JD);
+        double diameter = 2.0 * geometry.moonSemidiameter;
+        LunarEclipse eclipse;
+        eclipse.greatestJD = greatest_JD;
+        eclipse.umbralMagnitude = (geometry.umbraRadius + geometry.moonSemidiameter - geometry.separation) / diameter;
+        eclipse.penumbralMagnitude = (geometry.penumbraRadius + geometry.moonSemidiameter - geometry.separation) / diameter;
+        if (eclipse.penumbralMagnitude <= 0.0) {
+            continue;
+        }
+        eclipse.type = eclipse.umbralMagnitude >= 1.0 ? LunarEclipseType::Total
+                       : eclipse.umbralMagnitude > 0.0 ? LunarEclipseType::Partial
+                                                        : LunarEclipseType::Penumbral;
+        eclipses.push_back(eclipse);
+    }
+    return eclipses;
+}
+
+#endif
@@ -0,0 +1,380 @@
+#ifndef TSUKI_EPHEMERIS_CPP
+#define TSUKI_EPHEMERIS_CPP
+
+#define _USE_MATH_DEFINES
+
+#include <array>
+#include <cmath>
+#include <span>
+
+#include <SimdMath.cpp>
+#include <LunarSeries.cpp>
+
+constexpr double PI = M_PI;
+constexpr double DEG_TO_RAD = PI / 180.0;
+constexpr double RAD_TO_DEG = 180.0 / PI;
+constexpr double JD_2000_0 = 2451545.0;
+constexpr double EARTH_RADIUS_KM = 6378.137;
+
+template <typename V>
+SIMD_INLINE V degreesToRadians(const V& deg) {
+    return deg * DEG_TO_RAD;
+}
+
+template <typename V>
+SIMD_INLINE V radiansToDegrees(const V& rad) {
+    return rad * RAD_TO_DEG;
+}
+
+inline double normalizeDegrees(double angle) {
+    double result = fmod(angle, 360.0);
+    if (result < 0) {
+        result += 360.0;
+    }
+    return result;
+}
+
+inline double normalizeRadians(double angle) {
+    double result = fmod(angle, 2.0 * PI);
+    if (result < 0) {
+        result += 2.0 * PI;
+    }
+    return result;
+}
+
+// Mean arguments of the Sun-Moon system for one epoch (Meeus ch. 22, 25 and 47), shared by
+// the nutation, solar and lunar models so each epoch pays for them once. Angles other than
+// the mean longitudes are stored in radians, ready for the series.
+template <typename V = double>
+struct FundamentalArguments {
+    V T;                     // Julian centuries since J2000.0
+    V moonMeanLongitude;     // L', degrees in [0, 360)
+    V sunMeanLongitude;      // L0, degrees in [0, 360)
+    V elongation;            // D
+    V sunMeanAnomaly;        // M
+    V moonMeanAnomaly;       // M'
+    V argumentOfLatitude;    // F
+    V ascendingNode;         // Omega
+};
+
+struct SolarCoords {
+    double eclipticLongitude;
+    double radiusVector;
+};
+
+struct LunarCoords {
+    double eclipticLongitude;
+    double eclipticLatitude;
+    double radiusVector;
+};
+
+struct SolarCoordsBatch {
+    std::span<double> eclipticLongitude;
+    std::span<double> radiusVector;
+};
+
+struct LunarCoordsBatch {
+    std::span<double> eclipticLongitude;
+    std::span<double> eclipticLatitude;
+    std::span<double> radiusVector;
+};
+
+struct FundamentalArgumentsBatch {
+    std::span<double> T;
+    std::span<double> moonMeanLongitude;
+    std::span<double> sunMeanLongitude;
+    std::span<double> elongation;
+    std::span<double> sunMeanAnomaly;
+    std::span<double> moonMeanAnomaly;
+    std::span<double> argumentOfLatitude;
+    std::span<double> ascendingNode;
+};
+
+struct ObliquityAndNutationBatch {
+    std::span<double> meanObliquity;
+    std::span<double> deltaPsi;
+    std::span<double> deltaEpsilon;
+};
+
+inline double getGMST(double JD) {
+    double T = (JD - JD_2000_0) / 36525.0;
+
+    double GMST_deg = 280.46061837 + 360.98564736629 * (JD - JD_2000_0) +
+                      0.000387933 * T * T - T * T * T / 38710000.0;
+
+    return normalizeDegrees(GMST_deg);
+}
+
+template <typename V>
+SIMD_INLINE FundamentalArguments<V> fundamentalArgumentsKernel(const V& JD) {
+    FundamentalArguments<V> args;
+    V T = (JD - JD_2000_0) / 36525.0;
+    args.T = T;
+    args.moonMeanLongitude = normalizeDegrees(218.3164477 + T * (481267.88123421 + T * (-0.0015786 + T * (1.0 / 538841.0 - T / 65194000.0))));
+    args.sunMeanLongitude = normalizeDegrees(280.46646 + T * (36000.76983 + T * 0.0003032));
+    args.elongation = degreesToRadians(normalizeDegrees(297.8501921 + T * (445267.1114034 + T * (-0.0018819 + T * (1.0 / 545868.0 - T / 113065000.0)))));
+    args.sunMeanAnomaly = degreesToRadians(normalizeDegrees(357.5291092 + T * (35999.0502909 + T * (-0.0001536 + T / 24490000.0))));
+    args.moonMeanAnomaly = degreesToRadians(normalizeDegrees(134.9633964 + T * (477198.8675055 + T * (0.0087414 + T * (1.0 / 69699.0 - T / 14712000.0)))));
+    args.argumentOfLatitude = degreesToRadians(normalizeDegrees(93.2720950 + T * (483202.0175233 + T * (-0.0036539 + T * (-1.0 / 3526000.0 + T / 863310000.0)))));
+    args.ascendingNode = degreesToRadians(normalizeDegrees(125.04452 + T * (-1934.136261 + T * (0.0020708 + T / 450000.0))));
+    return args;
+}
+
+inline FundamentalArguments<> getFundamentalArguments(double JD) {
+    return fundamentalArgumentsKernel(JD);
+}
+
+template <typename V>
+SIMD_INLINE V obliquityAndNutationKernel(const FundamentalArguments<V>& args, V& delta_psi, V& delta_epsilon) {
+    const V& T = args.T;
+
+    V epsilon0_arcsec = 84381.448 - 46.8150 * T - 0.00059 * T * T + 0.001813 * T * T * T;
+    V epsilon0_deg = epsilon0_arcsec / 3600.0;
+
+    V L_prime = degreesToRadians(args.moonMeanLongitude);
+    const V& F = args.argumentOfLatitude;
+    const V& Omega = args.ascendingNode;
+
+    delta_psi = (-17.200 * sin(Omega) - 1.319 * sin(2 * L_prime) - 0.227 * sin(2 * F) + 0.206 * sin(2 * Omega)) / 3600.0; // in degrees
+    delta_epsilon = (9.202 * cos(Omega) + 0.573 * cos(2 * L_prime) + 0.098 * cos(2 * F) - 0.090 * cos(2 * Omega)) / 3600.0; // in degrees
+
+    return epsilon0_deg;
+}
+
+inline double getObliquityAndNutation(const FundamentalArguments<>& args, double& delta_psi, double& delta_epsilon) {
+    return obliquityAndNutationKernel(args, delta_psi, delta_epsilon);
+}
+
+inline double getObliquityAndNutation(double JD, double& delta_psi, double& delta_epsilon) {
+    return getObliquityAndNutation(getFundamentalArguments(JD), delta_psi, delta_epsilon);
+}
+
+template <typename V>
+SIMD_INLINE void solarCoordinatesKernel(const FundamentalArguments<V>& args, V& lambda_sun, V& R_sun_AU) {
+    const V& M_sun_rad = args.sunMeanAnomaly;
+
+    V C_sun_deg = 1.9148 * sin(M_sun_rad) + 0.0200 * sin(2 * M_sun_rad) + 0.0003 * sin(3 * M_sun_rad);
+
+    const V& L0_sun_deg = args.sunMeanLongitude;
+
+    lambda_sun = normalizeDegrees(L0_sun_deg + C_sun_deg);
+
+    R_sun_AU = 1.00014 - 0.01671 * cos(M_sun_rad) - 0.00014 * cos(2 * M_sun_rad);
+}
+
+inline SolarCoords getSolarCoordinates(const FundamentalArguments<>& args) {
+    SolarCoords sun;
+    solarCoordinatesKernel(args, sun.eclipticLongitude, sun.radiusVector);
+    return sun;
+}
+
+inline SolarCoords getSolarCoordinates(double JD) {
+    return getSolarCoordinates(getFundamentalArguments(JD));
+}
+
+template <LunarPrecision Precision, typename V>
+SIMD_INLINE void lunarCoordinatesKernel(const FundamentalArguments<V>& fundamentals, V& lambda_moon, V& beta_moon, V& R_moon) {
+    const V& L_prime = fundamentals.moonMeanLongitude;
+    const V angles_rad[4] = {fundamentals.elongation, fundamentals.sunMeanAnomaly, fundamentals.moonMeanAnomaly, fundamentals.argumentOfLatitude};
+    ArgumentMultiples<V> args;
+    makeArgumentMultiples(angles_rad, args);
+
+    if constexpr (Precision == LunarPrecision::Full) {
+        const V& T = fundamentals.T;
+        V A1 = degreesToRadians(normalizeDegrees(119.75 + 131.849 * T));
+        V A2 = degreesToRadians(normalizeDegrees(53.09 + 479264.290 * T));
+        V A3 = degreesToRadians(normalizeDegrees(313.45 + 481266.484 * T));
+        V E = 1.0 - T * (0.002516 + 0.0000074 * T);
+        setEccentricity(E, args);
+
+        V L_prime_rad = degreesToRadians(L_prime);
+        V sin_L_prime = sin(L_prime_rad);
+        V cos_L_prime = cos(L_prime_rad);
+        V sin_A1 = sin(A1);
+        V cos_A1 = cos(A1);
+        const V& sin_F = args.sin[3][1];
+        const V& cos_F = args.cos[3][1];
+        const V& sin_M_prime = args.sin[2][1];
+        const V& cos_M_prime = args.cos[2][1];
+
+        V sum_lon = evaluateSineSeries<MEEUS_LUNAR_LONGITUDE_TERMS, true>(args);
+        sum_lon += 3958.0 * sin_A1;
+        sum_lon += 1962.0 * (sin_L_prime * cos_F - cos_L_prime * sin_F);
+        sum_lon += 318.0 * sin(A2);
+
+        V sum_lat = evaluateSineSeries<MEEUS_LUNAR_LATITUDE_TERMS, true>(args);
+        sum_lat -= 2235.0 * sin_L_prime;
+        sum_lat += 382.0 * sin(A3);
+        sum_lat += 175.0 * (sin_A1 * cos_F - cos_A1 * sin_F);
+        sum_lat += 175.0 * (sin_A1 * cos_F + cos_A1 * sin_F);
+        sum_lat += 127.0 * (sin_L_prime * cos_M_prime - cos_L_prime * sin_M_prime);
+        sum_lat -= 115.0 * (sin_L_prime * cos_M_prime + cos_L_prime * sin_M_prime);
+
+        lambda_moon = normalizeDegrees(L_prime + sum_lon / 1000000.0);
+        beta_moon = sum_lat / 1000000.0;
+        R_moon = MEEUS_LUNAR_MEAN_DISTANCE_KM + evaluateCosineSeries<MEEUS_LUNAR_DISTANCE_TERMS, true>(args) / 1000.0;
+    } else if constexpr (Precision == LunarPrecision::Fast) {
+        lambda_moon = normalizeDegrees(L_prime + evaluateSineSeries<FAST_LUNAR_LONGITUDE_TERMS>(args));
+        beta_moon = evaluateSineSeries<FAST_LUNAR_LATITUDE_TERMS>(args);
+        R_moon = FAST_LUNAR_MEAN_DISTANCE_KM + evaluateCosineSeries<FAST_LUNAR_DISTANCE_TERMS>(args);
+    } else {
+        lambda_moon = normalizeDegrees(L_prime + evaluateSineSeries<STANDARD_LUNAR_LONGITUDE_TERMS>(args));
+        beta_moon = evaluateSineSeries<STANDARD_LUNAR_LATITUDE_TERMS>(args);
+        R_moon = STANDARD_LUNAR_MEAN_DISTANCE_KM + evaluateCosineSeries<STANDARD_LUNAR_DISTANCE_TERMS>(args);
+    }
+}
+
+template <LunarPrecision Precision>
+LunarCoords getLunarCoordinates(const FundamentalArguments<>& args) {
+    LunarCoords moon;
+    lunarCoordinatesKernel<Precision>(args, moon.eclipticLongitude, moon.eclipticLatitude, moon.radiusVector);
+    return moon;
+}
+
+template <LunarPrecision Precision>
+LunarCoords getLunarCoordinates(double JD) {
+    return getLunarCoordinates<Precision>(getFundamentalArguments(JD));
+}
+
+inline LunarCoords getLunarCoordinates(const FundamentalArguments<>& args, LunarPrecision precision = LunarPrecision::Standard) {
+    switch (precision) {
+        case LunarPrecision::Fast:
+            return getLunarCoordinates<LunarPrecision::Fast>(args);
+        case LunarPrecision::Full:
+            return getLunarCoordinates<LunarPrecision::Full>(args);
+        default:
+            return getLunarCoordinates<LunarPrecision::Standard>(args);
+    }
+}
+
+inline LunarCoords getLunarCoordinates(double JD, LunarPrecision precision = LunarPrecision::Standard) {
+    return getLunarCoordinates(getFundamentalArguments(JD), precision);
+}
+
+struct FundamentalArgumentsKernel {
+    template <typename V>
+    SIMD_INLINE static void run(const V& JD, V* out) {
+        FundamentalArguments<V> args = fundamentalArgumentsKernel(JD);
+        out[0] = args.T;
+        out[1] = args.moonMeanLongitude;
+        out[2] = args.sunMeanLongitude;
+        out[3] = args.elongation;
+        out[4] = args.sunMeanAnomaly;
+        out[5] = args.moonMeanAnomaly;
+        out[6] = args.argumentOfLatitude;
+        out[7] = args.ascendingNode;
+    }
+};
+
+struct ObliquityAndNutationKernel {
+    template <typename V>
+    SIMD_INLINE static void run(const V& JD, V* out) {
+        out[0] = obliquityAndNutationKernel(fundamentalArgumentsKernel(JD), out[1], out[2]);
+    }
+};
+
+struct SolarCoordsKernel {
+    template <typename V>
+    SIMD_INLINE static void run(const V& JD, V* out) {
+        solarCoordinatesKernel(fundamentalArgumentsKernel(JD), out[0], out[1]);
+    }
+};
+
+template <LunarPrecision Precision>
+struct LunarCoordsKernel {
+    template <typename V>
+    SIMD_INLINE static void run(const V& JD, V* out) {
+        lunarCoordinatesKernel<Precision>(fundamentalArgumentsKernel(JD), out[0], out[1], out[2]);
+    }
+};
+
+template <typename V>
+SIMD_INLINE void evaluateBatch(std::span<const double> JDs, const FundamentalArgumentsBatch& out) {
+    simdBatch<V, 8, FundamentalArgumentsKernel>(JDs, {out.T, out.moonMeanLongitude, out.sunMeanLongitude, out.elongation,
+                                                      out.sunMeanAnomaly, out.moonMeanAnomaly, out.argumentOfLatitude, out.ascendingNode});
+}
+
+template <typename V>
+SIMD_INLINE void evaluateBatch(std::span<const double> JDs, const ObliquityAndNutationBatch& out) {
+    simdBatch<V, 3, ObliquityAndNutationKernel>(JDs, {out.meanObliquity, out.deltaPsi, out.deltaEpsilon});
+}
+
+template <typename V>
+SIMD_INLINE void evaluateBatch(std::span<const double> JDs, const SolarCoordsBatch& out) {
+    simdBatch<V, 2, SolarCoordsKernel>(JDs, {out.eclipticLongitude, out.radiusVector});
+}
+
+template <typename V>
+SIMD_INLINE void evaluateBatch(std::span<const double> JDs, const LunarCoordsBatch& out, LunarPrecision precision) {
+    const std::array<std::span<double>, 3> outputs = {out.eclipticLongitude, out.eclipticLatitude, out.radiusVector};
+    switch (precision) {
+        case LunarPrecision::Fast:
+            simdBatch<V, 3, LunarCoordsKernel<LunarPrecision::Fast>>(JDs, outputs);
+            return;
+        case LunarPrecision::Full:
+            simdBatch<V, 3, LunarCoordsKernel<LunarPrecision::Full>>(JDs, outputs);
+            return;
+        default:
+            simdBatch<V, 3, LunarCoordsKernel<LunarPrecision::Standard>>(JDs, outputs);
+            return;
+    }
+}
+
+#ifdef TSUKI_X86_SIMD
+template <typename Batch, typename... Options>
+__attribute__((target("avx512f"))) void evaluateBatchAvx512(std::span<const double> JDs, const Batch& out, Options... options) {
+    evaluateBatch<vdouble8>(JDs, out, options...);
+}
+
+template <typename Batch, typename... Options>
+__attribute__((target("avx2,fma"))) void evaluateBatchAvx2(std::span<const double> JDs, const Batch& out, Options... options) {
+    evaluateBatch<vdouble4>(JDs, out, options...);
+}
+
+template <typename Batch, typename... Options>
+__attribute__((target("sse2"))) void evaluateBatchSse2(std::span<const double> JDs, const Batch& out, Options... options) {
+    evaluateBatch<vdouble4>(JDs, out, options...);
+}
+#endif
+
+template <typename Batch, typename... Options>
+void dispatchBatch(std::span<const double> JDs, const Batch& out, Options... options) {
+    switch (activeSimdLevel()) {
+#ifdef TSUKI_X86_SIMD
+        case SimdLevel::AVX512:
+            evaluateBatchAvx512(JDs, out, options...);
+            return;
+        case SimdLevel::AVX2:
+            evaluateBatchAvx2(JDs, out, options...);
+            return;
+        case SimdLevel::SSE2:
+            evaluateBatchSse2(JDs, out, options...);
+            return;
+#endif
+        default:
+            evaluateBatch<double>(JDs, out, options...);
+            return;
+    }
+}
+
+// Batch versions of the models above, one output value per input JD. At SimdLevel::Scalar
+// the results are bit-identical to the scalar functions. The vector levels use simdSinCos
+// instead of libm (and FMA contraction on AVX2/AVX-512), and stay within 1e-10 degrees and
+// 1e-7 km of the scalar path.
+inline void getFundamentalArguments(std::span<const double> JDs, const FundamentalArgumentsBatch& out) {
+    dispatchBatch(JDs, out);
+}
+
+inline void getObliquityAndNutation(std::span<const double> JDs, const ObliquityAndNutationBatch& out) {
+    dispatchBatch(JDs, out);
+}
+
+inline void getSolarCoordinates(std::span<const double> JDs, const SolarCoordsBatch& out) {
+    dispatchBatch(JDs, out);
+}
+
+inline void getLunarCoordinates(std::span<const double> JDs, const LunarCoordsBatch& out, LunarPrecision precision = LunarPrecision::Standard) {
+    dispatchBatch(JDs, out, precision);
+}
+
+#endif
@@ -0,0 +1,237 @@
+#ifndef TSUKI_EPHEMERIS_CACHE_CPP
+#define TSUKI_EPHEMERIS_CACHE_CPP
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include <Ephemeris.cpp>
+
+// Chebyshev fits to the geocentric Moon (Full tier) and Sun over fixed 4-day segments,
+// built on first use and shared by every caller in the process. A lookup is a hash probe
+// under a shared lock plus a 13-term Clenshaw sum per coordinate; the fits reproduce the
+// series to about 1e-5 arcseconds and 2e-6 km.
+//
+// Segments cost ~560 bytes each and the cache holds at most maxSegments of them (the
+// default 4096 covers about 45 years in ~2.3 MB). Once full, a clock (second-chance)
+// sweep evicts a segment that has not been read since the hand last passed it.
+class EphemerisCache {
+public:
+    static constexpr double SEGMENT_DAYS = 4.0;
+    static constexpr int COEFFICIENTS = 13;
+    static constexpr std::size_t DEFAULT_MAX_SEGMENTS = 4096;
+    // Segments are indexed within this many days of J2000 (about +/-27,000 years, far past
+    // where the series mean anything); other epochs, and NaN, go straight to the series.
+    static constexpr double MAX_SPAN_DAYS = 1.0e7;
+
+    explicit EphemerisCache(std::size_t max_segments = DEFAULT_MAX_SEGMENTS)
+        : maxSegments(max_segments > 0 ? max_segments : 1) {}
+
+    static EphemerisCache& shared() {
+        static EphemerisCache cache;
+        return cache;
+    }
+
+    enum Component {
+        MOON_LONGITUDE,
+        MOON_LATITUDE,
+        MOON_DISTANCE,
+        SUN_LONGITUDE,
+        SUN_DISTANCE,
+        COMPONENT_COUNT
+    };
+
+    using Coefficients = std::array<std::array<double, COEFFICIENTS>, COMPONENT_COUNT>;
+
+    LunarCoords lunar(double JD) {
+        if (!covers(JD)) {
+            return getLunarCoordinates(JD, LunarPrecision::Full);
+        }
+        return lookup<LunarCoords>(JD, lunarAt);
+    }
+
+    SolarCoords solar(double JD) {
+        if (!covers(JD)) {
+            return getSolarCoordinates(JD);
+        }
+        return lookup<SolarCoords>(JD, solarAt);
+    }
+
+    // Whether JD has a segment; false for NaN and infinities.
+    static bool covers(double JD) {
+        return std::abs(JD - JD_2000_0) <= MAX_SPAN_DAYS;
+    }
+
+    // Only defined where covers(JD).
+    static std::int64_t segmentIndex(double JD) {
+        return static_cast<std::int64_t>(std::floor((JD - JD_2000_0) / SEGMENT_DAYS));
+    }
+
+    static double segmentStart(std::int64_t index) {
+        return JD_2000_0 + static_cast<double>(index) * SEGMENT_DAYS;
+    }
+
+    // Position of JD within its segment, scaled to the Chebyshev interval [-1, 1].
+    static double segmentOffset(double JD, std::int64_t index) {
+        return 2.0 * (JD - segmentStart(index)) / SEGMENT_DAYS - 1.0;
+    }
+
+    static LunarCoords lunarAt(const Coefficients& coefficients, double x) {
+        return LunarCoords{
+            normalizeDegrees(evaluate(coefficients[MOON_LONGITUDE], x)),
+            evaluate(coefficients[MOON_LATITUDE], x),
+            evaluate(coefficients[MOON_DISTANCE], x)
+        };
+    }
+
+    static SolarCoords solarAt(const Coefficients& coefficients, double x) {
+        return SolarCoords{
+            normalizeDegrees(evaluate(coefficients[SUN_LONGITUDE], x)),
+            evaluate(coefficients[SUN_DISTANCE], x)
+        };
+    }
+
+    // Fits every component over segment `index` from the Full-tier series.
+    static Coefficients fitSegment(std::int64_t index) {
+        const auto& basis = nodeBasis();
+        const double half = SEGMENT_DAYS / 2.0;
+        const double mid = segmentStart(index) + half;
+
+        std::array<double, COEFFICIENTS> nodes;
+        for (int k = 0; k < COEFFICIENTS; ++k) {
+            nodes[k] = mid + half * basis[1][k];
+        }
+
+        std::array<std::array<double, COEFFICIENTS>, COMPONENT_COUNT> samples;
+        getLunarCoordinates(nodes, {samples[MOON_LONGITUDE], samples[MOON_LATITUDE], samples[MOON_DISTANCE]}, LunarPrecision::Full);
+        getSolarCoordinates(nodes, {samples[SUN_LONGITUDE], samples[SUN_DISTANCE]});
+        unwrapDegrees(samples[MOON_LONGITUDE]);
+        unwrapDegrees(samples[SUN_LONGITUDE]);
+
+        Coefficients coefficients;
+        for (int component = 0; component < COMPONENT_COUNT; ++component) {
+            for (int j = 0; j < COEFFICIENTS; ++j) {
+                double sum = 0.0;
+                for (int k = 0; k < COEFFICIENTS; ++k) {
+                    sum += samples[component][k] * basis[j][k];
+                }
+                coefficients[component][j] = (j == 0 ? 1.0 : 2.0) * sum / COEFFICIENTS;
+            }
+        }
+        return coefficients;
+    }
+
+    std::size_t size() const {
+        std::shared_lock lock(mutex);
+        return slotByIndex.size();
+    }
+
+    std::size_t capacity() const {
+        return maxSegments;
+    }
+
+    void clear() {
+        std::unique_lock lock(mutex);
+        slotByIndex.clear();
+        segments.clear();
+        clockHand = 0;
+    }
+
+private:
+    struct Segment {
+        std::int64_t index = 0;
+        Coefficients coefficients{};
+        mutable std::atomic<bool> referenced{false};
+    };
+
+    std::size_t maxSegments;
+    mutable std::shared_mutex mutex;
+    std::deque<Segment> segments;
+    std::unordered_map<std::int64_t, std::size_t> slotByIndex;
+    std::size_t clockHand = 0;
+
+    static double evaluate(const std::array<double, COEFFICIENTS>& c, double x) {
+        double b1 = 0.0;
+        double b2 = 0.0;
+        for (int j = COEFFICIENTS - 1; j >= 1; --j) {
+            double b0 = 2.0 * x * b1 - b2 + c[j];
+            b2 = b1;
+            b1 = b0;
+        }
+        return x * b1 - b2 + c[0];
+    }
+
+    // cos(pi * j * (k + 0.5) / N): the Chebyshev basis sampled at the Chebyshev nodes.
+    static const std::array<std::array<double, COEFFICIENTS>, COEFFICIENTS>& nodeBasis() {
+        static const auto basis = [] {
+            std::array<std::array<double, COEFFICIENTS>, COEFFICIENTS> b{};
+            for (int j = 0; j < COEFFICIENTS; ++j) {
+                for (int k = 0; k < COEFFICIENTS; ++k) {
+                    b[j][k] = cos(PI * j * (k + 0.5) / COEFFICIENTS);
+                }
+            }
+            return b;
+        }();
+        return basis;
+    }
+
+    static void unwrapDegrees(std::array<double, COEFFICIENTS>& angles) {
+        for (int k = 1; k < COEFFICIENTS; ++k) {
+            angles[k] = angles[k - 1] + remainder(angles[k] - angles[k - 1], 360.0);
+        }
+    }
+
+    // Caller holds the unique lock.
+    std::size_t claimSlot() {
+        if (segments.size() < maxSegments) {
+            segments.emplace_back();
+            return segments.size() - 1;
+        }
+
+        while (true) {
+            std::size_t slot = clockHand;
+            clockHand = (clockHand + 1) % segments.size();
+            if (!segments[slot].referenced.exchange(false, std::memory_order_relaxed)) {
+                slotByIndex.erase(segments[slot].index);
+                return slot;
+            }
+        }
+    }
+
+    template <typename Result, typename Evaluate>
+    Result lookup(double JD, Evaluate evaluateSegment) {
+        const std::int64_t index = segmentIndex(JD);
+        const double x = segmentOffset(JD, index);
+
+        {
+            std::shared_lock lock(mutex);
+            auto it = slotByIndex.find(index);
+            if (it != slotByIndex.end()) {
+                const Segment& segment = segments[it->second];
+                segment.referenced.store(true, std::memory_order_relaxed);
+                return evaluateSegment(segment.coefficients, x);
+            }
+        }
+
+        Coefficients coefficients = fitSegment(index);
+
+        std::unique_lock lock(mutex);
+        auto it = slotByIndex.find(index);
+        if (it == slotByIndex.end()) {
+            std::size_t slot = claimSlot();
+            segments[slot].index = index;
+            segments[slot].coefficients = coefficients;
+            segments[slot].referenced.store(true, std::memory_order_relaxed);
+            it = slotByIndex.emplace(index, slot).first;
+        }
+        return evaluateSegment(segments[it->second].coefficients, x);
+    }
+};
+
+#endif
@@ -0,0 +1,416 @@
+#ifndef TSUKI_EPHEMERIS_FILE_CPP
+#define TSUKI_EPHEMERIS_FILE_CPP
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <EphemerisCache.cpp>
+
+// On-disk form of the EphemerisCache segments, so that processes can map one precomputed
+// span instead of fitting it themselves.
+//
+// Layout, all little-endian:
+//   EphemerisFileHeader (64 bytes)
+//   segmentCount x EphemerisCache::Coefficients (components x coefficients doubles each)
+//
+// Segment i covers [segmentStart(firstSegment + i), +SEGMENT_DAYS). The header checksum
+// covers the header fields and the payload checksum covers every coefficient; both are
+// FNV-1a over 64-bit values so they do not depend on the host byte order.
+struct EphemerisFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t components;
+    std::uint32_t coefficients;
+    double segmentDays;
+    std::int64_t firstSegment;
+    std::uint64_t segmentCount;
+    std::uint64_t payloadChecksum;
+    std::uint64_t headerChecksum;
+};
+
+static_assert(sizeof(EphemerisFileHeader) == 64);
+static_assert(sizeof(EphemerisCache::Coefficients) ==
+              sizeof(double) * EphemerisCache::COMPONENT_COUNT * EphemerisCache::COEFFICIENTS);
+
+constexpr char EPHEMERIS_FILE_MAGIC[8] = {'T', 'S', 'U', 'K', 'I', 'E', 'P', 'H'};
+constexpr std::uint32_t EPHEMERIS_FILE_VERSION = 1;
+constexpr std::uint32_t EPHEMERIS_FILE_BYTE_ORDER = 0x01020304;
+
+namespace {
+
+constexpr bool HOST_IS_LITTLE_ENDIAN = std::endian::native == std::endian::little;
+
+std::uint32_t byteSwap(std::uint32_t v) {
+    return ((v & 0x000000FFu) << 24) | ((v & 0x0000FF00u) << 8) |
+           ((v & 0x00FF0000u) >> 8) | ((v & 0xFF000000u) >> 24);
+}
+
+std::uint64_t byteSwap(std::uint64_t v) {
+    return (static_cast<std::uint64_t>(byteSwap(static_cast<std::uint32_t>(v))) << 32) |
+           byteSwap(static_cast<std::uint32_t>(v >> 32));
+}
+
+std::int64_t byteSwap(std::int64_t v) {
+    return std::bit_cast<std::int64_t>(byteSwap(std::bit_cast<std::uint64_t>(v)));
+}
+
+double byteSwap(double v) {
+    return std::bit_cast<double>(byteSwap(std::bit_cast<std::uint64_t>(v)));
+}
+
+void swapHeader(EphemerisFileHeader& header) {
+    header.version = byteSwap(header.version);
+    header.byteOrder = byteSwap(header.byteOrder);
+    header.components = byteSwap(header.components);
+    header.coefficients = byteSwap(header.coefficients);
+    header.segmentDays = byteSwap(header.segmentDays);
+    header.firstSegment = byteSwap(header.firstSegment);
+    header.segmentCount = byteSwap(header.segmentCount);
+    header.payloadChecksum = byteSwap(header.payloadChecksum);
+    header.headerChecksum = byteSwap(header.headerChecksum);
+}
+
+constexpr std::uint64_t FNV_OFFSET = 14695981039346656037ull;
+constexpr std::uint64_t FNV_PRIME = 1099511628211ull;
+
+std::uint64_t fnvMix(std::uint64_t hash, std::uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (value >> (8 * i)) & 0xFF;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+std::uint64_t headerChecksum(const EphemerisFileHeader& header) {
+    std::uint64_t hash = FNV_OFFSET;
+    for (char c : header.magic) {
+        hash = fnvMix(hash, static_cast<unsigned char>(c));
+    }
+    hash = fnvMix(hash, header.version);
+    hash = fnvMix(hash, header.byteOrder);
+    hash = fnvMix(hash, header.components);
+    hash = fnvMix(hash, header.coefficients);
+    hash = fnvMix(hash, std::bit_cast<std::uint64_t>(header.segmentDays));
+    hash = fnvMix(hash, std::bit_cast<std::uint64_t>(header.firstSegment));
+    hash = fnvMix(hash, header.segmentCount);
+    hash = fnvMix(hash, header.payloadChecksum);
+    return hash;
+}
+
+std::uint64_t payloadChecksum(const EphemerisCache::Coefficients* segments, std::uint64_t count) {
+    std::uint64_t hash = FNV_OFFSET;
+    for (std::uint64_t i = 0; i < count; ++i) {
+        for (const auto& component : segments[i]) {
+            for (double c : component) {
+                hash = fnvMix(hash, std::bit_cast<std::uint64_t>(c));
+            }
+        }
+    }
+    return hash;
+}
+
+}
+
+// Writes segments covering [startJD, endJD]. Returns false (after reporting why) on failure.
+inline bool writeEphemerisFile(const std::string& path, double startJD, double endJD) {
+    if (!(endJD >= startJD)) {
+        std::cerr << "Error: ephemeris end date precedes its start date." << std::endl;
+        return false;
+    }
+    if (!EphemerisCache::covers(startJD) || !EphemerisCache::covers(endJD)) {
+        std::cerr << "Error: ephemeris span is outside the range the segments can index." << std::endl;
+        return false;
+    }
+
+    const std::int64_t first = EphemerisCache::segmentIndex(startJD);
+    const std::int64_t last = EphemerisCache::segmentIndex(endJD);
+    std::vector<EphemerisCache::Coefficients> segments(static_cast<std::size_t>(last - first + 1));
+    for (std::size_t i = 0; i < segments.size(); ++i) {
+        segments[i] = EphemerisCache::fitSegment(first + static_cast<std::int64_t>(i));
+    }
+
+    EphemerisFileHeader header{};
+    std::memcpy(header.magic, EPHEMERIS_FILE_MAGIC, sizeof(header.magic));
+    header.version = EPHEMERIS_FILE_VERSION;
+    header.byteOrder = EPHEMERIS_FILE_BYTE_ORDER;
+    header.components = EphemerisCache::COMPONENT_COUNT;
+    header.coefficients = EphemerisCache::COEFFICIENTS;
+    header.segmentDays = EphemerisCache::SEGMENT_DAYS;
+    header.firstSegment = first;
+    header.segmentCount = segments.size();
+    header.payloadChecksum = payloadChecksum(segments.data(), segments.size());
+    header.headerChecksum = headerChecksum(header);
+
+    if constexpr (!HOST_IS_LITTLE_ENDIAN) {
+        swapHeader(header);
+        for (auto& segment : segments) {
+            for (auto& component : segment) {
+                for (double& c : component) {
+                    c = byteSwap(c);
+                }
+            }
+        }
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(segments.data()),
+              static_cast<std::streamsize>(segments.size() * sizeof(EphemerisCache::Coefficients)));
+    out.close();
+    if (!out) {
+        std::cerr << "Error: could not write ephemeris file " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// A segment of an ephemeris file and the position of a JD within it, scaled to [-1, 1].
+// `coefficients` is nullptr when the file does not cover the JD.
+struct EphemerisFileSegment {
+    const EphemerisCache::Coefficients* coefficients = nullptr;
+    double x = 0.0;
+};
+
+// Read-only view of an ephemeris file. On little-endian hosts the coefficients are used
+// straight out of the mapping; big-endian hosts get a byte-swapped private copy.
+class EphemerisFile {
+public:
+    // Returns nullptr (after reporting why) if the file is missing, truncated, from another
+    // format version, or fails either checksum.
+    static std::unique_ptr<EphemerisFile> open(const std::string& path) {
+        std::unique_ptr<EphemerisFile> file(new EphemerisFile());
+        if (!file->map(path)) {
+            std::cerr << "Error: could not map ephemeris file " << path << std::endl;
+            return nullptr;
+        }
+        if (!file->validate()) {
+            std::cerr << "Error: " << path << " is not a valid tsuki ephemeris file." << std::endl;
+            return nullptr;
+        }
+        return file;
+    }
+
+    EphemerisFile(const EphemerisFile&) = delete;
+    EphemerisFile& operator=(const EphemerisFile&) = delete;
+
+    ~EphemerisFile() {
+        unmap();
+    }
+
+    double startJD() const {
+        return EphemerisCache::segmentStart(header.firstSegment);
+    }
+
+    double endJD() const {
+        return EphemerisCache::segmentStart(header.firstSegment + static_cast<std::int64_t>(header.segmentCount));
+    }
+
+    bool covers(double JD) const {
+        return JD >= startJD() && JD < endJD();
+    }
+
+    // The segment containing JD; its coefficients are nullptr outside the file's span.
+    EphemerisFileSegment segment(double JD) const {
+        if (!EphemerisCache::covers(JD)) {
+            return {};
+        }
+        const std::int64_t index = EphemerisCache::segmentIndex(JD);
+        const std::int64_t offset = index - header.firstSegment;
+        if (offset < 0 || static_cast<std::uint64_t>(offset) >= header.segmentCount) {
+            return {};
+        }
+        return EphemerisFileSegment{&segments[offset], EphemerisCache::segmentOffset(JD, index)};
+    }
+
+private:
+    EphemerisFileHeader header{};
+    const EphemerisCache::Coefficients* segments = nullptr;
+    std::vector<EphemerisCache::Coefficients> swapped;
+    const unsigned char* data = nullptr;
+    std::size_t length = 0;
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+#endif
+
+    EphemerisFile() = default;
+
+    bool map(const std::string& path) {
+#ifdef _WIN32
+        fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart == 0) {
+            return false;
+        }
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle == nullptr) {
+            return false;
+        }
+        void* view = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if (view == nullptr) {
+            return false;
+        }
+        data = static_cast<const unsigned char*>(view);
+        length = static_cast<std::size_t>(size.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) {
+            return false;
+        }
+        data = static_cast<const unsigned char*>(view);
+        length = static_cast<std::size_t>(info.st_size);
+#endif
+        return true;
+    }
+
+    void unmap() {
+#ifdef _WIN32
+        if (data != nullptr) {
+            UnmapViewOfFile(data);
+        }
+        if (mappingHandle != nullptr) {
+            CloseHandle(mappingHandle);
+        }
+        if (fileHandle != INVALID_HANDLE_VALUE) {
+            CloseHandle(fileHandle);
+        }
+#else
+        if (data != nullptr) {
+            munmap(const_cast<unsigned char*>(data), length);
+        }
+#endif
+        data = nullptr;
+    }
+
+    bool validate() {
+        if (length < sizeof(EphemerisFileHeader)) {
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if constexpr (!HOST_IS_LITTLE_ENDIAN) {
+            swapHeader(header);
+        }
+
+        if (std::memcmp(header.magic, EPHEMERIS_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+            header.byteOrder != EPHEMERIS_FILE_BYTE_ORDER ||
+            header.version != EPHEMERIS_FILE_VERSION ||
+            header.headerChecksum != headerChecksum(header)) {
+            return false;
+        }
+        if (header.components != EphemerisCache::COMPONENT_COUNT ||
+            header.coefficients != EphemerisCache::COEFFICIENTS ||
+            header.segmentDays != EphemerisCache::SEGMENT_DAYS) {
+            return false;
+        }
+
+        const std::size_t payload_bytes = length - sizeof(EphemerisFileHeader);
+        if (header.segmentCount == 0 ||
+            header.segmentCount != payload_bytes / sizeof(EphemerisCache::Coefficients) ||
+            payload_bytes % sizeof(EphemerisCache::Coefficients) != 0) {
+            return false;
+        }
+
+        const auto* mapped = reinterpret_cast<const EphemerisCache::Coefficients*>(data + sizeof(EphemerisFileHeader));
+        if constexpr (HOST_IS_LITTLE_ENDIAN) {
+            segments = mapped;
+        } else {
+            swapped.assign(mapped, mapped + header.segmentCount);
+            for (auto& segment : swapped) {
+                for (auto& component : segment) {
+                    for (double& c : component) {
+                        c = byteSwap(c);
+                    }
+                }
+            }
+            segments = swapped.data();
+        }
+        return payloadChecksum(segments, header.segmentCount) == header.payloadChecksum;
+    }
+};
+
+// The process-wide ephemeris: a mapped file when one has been installed (or named by the
+// TSUKI_EPHEMERIS environment variable), falling back to EphemerisCache::shared() outside
+// the file's span. Installed files stay mapped for the life of the process so readers
+// never race an unmap.
+inline std::atomic<const EphemerisFile*>& installedEphemerisFile() {
+    static std::atomic<const EphemerisFile*> file{[]() -> const EphemerisFile* {
+        const char* path = std::getenv("TSUKI_EPHEMERIS");
+        if (path == nullptr || *path == '\0') {
+            return nullptr;
+        }
+        return EphemerisFile::open(path).release();
+    }()};
+    return file;
+}
+
+inline bool useEphemerisFile(const std::string& path) {
+    static std::mutex mutex;
+    static std::vector<std::unique_ptr<EphemerisFile>> retained;
+
+    std::unique_ptr<EphemerisFile> file = EphemerisFile::open(path);
+    if (!file) {
+        return false;
+    }
+    std::lock_guard lock(mutex);
+    installedEphemerisFile().store(file.get(), std::memory_order_release);
+    retained.push_back(std::move(file));
+    return true;
+}
+
+inline LunarCoords ephemerisLunarCoordinates(double JD) {
+    if (const EphemerisFile* file = installedEphemerisFile().load(std::memory_order_acquire)) {
+        EphemerisFileSegment segment = file->segment(JD);
+        if (segment.coefficients) {
+            return EphemerisCache::lunarAt(*segment.coefficients, segment.x);
+        }
+    }
+    return EphemerisCache::shared().lunar(JD);
+}
+
+inline SolarCoords ephemerisSolarCoordinates(double JD) {
+    if (const EphemerisFile* file = installedEphemerisFile().load(std::memory_order_acquire)) {
+        EphemerisFileSegment segment = file->segment(JD);
+        if (segment.coefficients) {
+            return EphemerisCache::solarAt(*segment.coefficients, segment.x);
+        }
+    }
+    return EphemerisCache::shared().solar(JD);
+}
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef TSUKI_GENERATOR_CPP
+#define TSUKI_GENERATOR_CPP
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+// Minimal lazy generator: the coroutine body runs only as far as the next co_yield each time
+// the iterator advances, and is destroyed with the Generator. Single pass, move-only.
+template <typename T>
+class Generator {
+public:
+    struct promise_type {
+        const T* current = nullptr;
+        std::exception_ptr exception;
+
+        Generator get_return_object() {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+        // The yielded object outlives the suspension (it is a local or a temporary of the
+        // co_yield expression), so only its address is kept.
+        std::suspend_always yield_value(const T& value) noexcept {
+            current = std::addressof(value);
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() {
+            exception = std::current_exception();
+        }
+        void await_transform() = delete;
+    };
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = T;
+
+        iterator() = default;
+        explicit iterator(std::coroutine_handle<promise_type> coroutine) : handle(coroutine) {}
+
+        const T& operator*() const {
+            return *handle.promise().current;
+        }
+        const T* operator->() const {
+            return handle.promise().current;
+        }
+        iterator& operator++() {
+            resume(handle);
+            return *this;
+        }
+        void operator++(int) {
+            ++*this;
+        }
+        bool operator==(std::default_sentinel_t) const {
+            return !handle || handle.done();
+        }
+
+    private:
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    Generator(Generator&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Generator& operator=(Generator&& other) noexcept {
+        if (this != &other) {
+            if (handle) {
+                handle.destroy();
+            }
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+    ~Generator() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    iterator begin() {
+        if (handle) {
+            resume(handle);
+        }
+        return iterator(handle);
+    }
+    std::default_sentinel_t end() const {
+        return {};
+    }
+
+private:
+    explicit Generator(std::coroutine_handle<promise_type> coroutine) : handle(coroutine) {}
+
+    static void resume(std::coroutine_handle<promise_type> coroutine) {
+        coroutine.resume();
+        if (coroutine.promise().exception) {
+            std::rethrow_exception(std::exchange(coroutine.promise().exception, nullptr));
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef TSUKI_HORIZON_SCAN_CPP
+#define TSUKI_HORIZON_SCAN_CPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <RootFinder.cpp>
+
+constexpr double HORIZON_ALT_DEG = -0.566;
+
+// Dense samples altitude at every DENSE_STEP_JD. Adaptive stretches the step while the body
+// is far from the target altitude: with |dh/dt| <= MAX_ALTITUDE_RATE, no crossing can occur
+// before (|h - target| - margin) / MAX_ALTITUDE_RATE, so skipping that far cannot miss an
+// event the dense scan would have seen.
+enum class HorizonScan {
+    Dense,
+    Adaptive
+};
+
+// Upper bound on the Moon's topocentric altitude rate: Earth rotation (15.04 deg/h) plus the
+// Moon's own motion and the change in parallax, with headroom.
+constexpr double MAX_LUNAR_ALTITUDE_RATE_DEG_PER_DAY = 16.5 * 24.0;
+constexpr double DENSE_STEP_JD = 5.0 / (24.0 * 60.0);
+constexpr double ADAPTIVE_MARGIN_DEG = 0.1;
+
+// Upper culmination: the instant and value of an altitude maximum.
+struct Culmination {
+    double JD;
+    double altitude;
+};
+
+struct HorizonCrossings {
+    std::vector<double> rises;
+    std::vector<double> sets;
+    std::vector<Culmination> culminations;
+    int evaluations = 0;
+};
+
+// One threshold of a multi-target scan: the source (body) it applies to and its altitude.
+struct HorizonTarget {
+    std::size_t source;
+    double altitude;
+};
+
+// Passed to an altitudes() callback to ask for every source.
+constexpr std::size_t ALL_SOURCES = std::numeric_limits<std::size_t>::max();
+
+// Finds where each source's altitude crosses each of its targets in [start_JD, end_JD], all
+// from one shared set of samples: altitudes(JD, out, ALL_SOURCES) writes the altitude of
+// every source at JD to out[0..sources), so whatever the sources have in common per epoch
+// (sidereal time, nutation) is computed once per sample. The adaptive step is the smallest
+// any target allows, so no target can miss a crossing. Crossings are refined to one second
+// with findRootBrent, calling altitudes(JD, out, source) so that only the source whose
+// bracket is being solved is evaluated. The same samples locate each source's altitude
+// maxima strictly inside the window: a sample higher than both neighbours brackets one,
+// which findMaximumBrent refines to one second. Returns one HorizonCrossings per target,
+// carrying its source's culminations; `evaluations` counts calls to altitudes().
+template <typename Altitudes>
+std::vector<HorizonCrossings> findHorizonCrossings(Altitudes&& altitudes, std::size_t sources, double start_JD, double end_JD,
+                                                   std::span<const HorizonTarget> targets,
+                                                   HorizonScan scan = HorizonScan::Adaptive,
+                                                   double max_rate_deg_per_day = MAX_LUNAR_ALTITUDE_RATE_DEG_PER_DAY) {
+    const double TOLERANCE_JD = 1.0 / (24.0 * 60.0 * 60.0);
+
+    std::vector<HorizonCrossings> crossings(targets.size());
+    int evaluations = 0;
+    std::vector<double> refinement(sources);
+    auto source_altitude = [&](std::size_t source, double offset) {
+        return [&, source, offset](double JD) {
+            ++evaluations;
+            altitudes(JD, refinement.data(), source);
+            return refinement[source] - offset;
+        };
+    };
+
+    std::vector<double> before_prev(sources, std::numeric_limits<double>::infinity());
+    std::vector<double> prev(sources);
+    std::vector<double> current(sources);
+    double before_prev_JD = start_JD;
+    double prev_JD = start_JD;
+    ++evaluations;
+    altitudes(prev_JD, prev.data(), ALL_SOURCES);
+
+    while (prev_JD < end_JD) {
+        double step = DENSE_STEP_JD;
+        if (scan == HorizonScan::Adaptive) {
+            double safe_days = std::numeric_limits<double>::infinity();
+            for (const HorizonTarget& target : targets) {
+                safe_days = std::min(safe_days, (std::abs(prev[target.source] - target.altitude) - ADAPTIVE_MARGIN_DEG) / max_rate_deg_per_day);
+            }
+            step = std::max(step, safe_days);
+        }
+        double current_JD = std::min(prev_JD + step, end_JD);
+        ++evaluations;
+        altitudes(current_JD, current.data(), ALL_SOURCES);
+
+        for (std::size_t i = 0; i < targets.size(); ++i) {
+            const HorizonTarget& target = targets[i];
+            double prev_diff = prev[target.source] - target.altitude;
+            double current_diff = current[target.source] - target.altitude;
+            if (prev_diff < 0.0 && current_diff >= 0.0) {
+                crossings[i].rises.push_back(findRootBrent(source_altitude(target.source, target.altitude), prev_JD, current_JD, prev_diff, current_diff, TOLERANCE_JD));
+            } else if (prev_diff > 0.0 && current_diff <= 0.0) {
+                crossings[i].sets.push_back(findRootBrent(source_altitude(target.source, target.altitude), prev_JD, current_JD, prev_diff, current_diff, TOLERANCE_JD));
+            }
+        }
+        for (std::size_t source = 0; source < sources; ++source) {
+            if (prev[source] > before_prev[source] && prev[source] >= current[source]) {
+                double max_altitude;
+                double JD = findMaximumBrent(source_altitude(source, 0.0), before_prev_JD, prev_JD, current_JD, prev[source], TOLERANCE_JD, max_altitude);
+                for (std::size_t i = 0; i < targets.size(); ++i) {
+                    if (targets[i].source == source) {
+                        crossings[i].culminations.push_back(Culmination{JD, max_altitude});
+                    }
+                }
+            }
+        }
+
+        std::swap(before_prev, prev);
+        std::swap(prev, current);
+        before_prev_JD = prev_JD;
+        prev_JD = current_JD;
+    }
+
+    for (HorizonCrossings& target_crossings : crossings) {
+        target_crossings.evaluations = evaluations;
+    }
+    return crossings;
+}
+
+// Single-source, single-target form: where altitude(JD) crosses target_alt_deg.
+template <typename Altitude>
+HorizonCrossings findHorizonCrossings(Altitude&& altitude, double start_JD, double end_JD, double target_alt_deg,
+                                      HorizonScan scan = HorizonScan::Adaptive,
+                                      double max_rate_deg_per_day = MAX_LUNAR_ALTITUDE_RATE_DEG_PER_DAY) {
+    const HorizonTarget targets[] = {{0, target_alt_deg}};
+    auto altitudes = [&](double JD, double* out, std::size_t) {
+        out[0] = altitude(JD);
+    };
+    return std::move(findHorizonCrossings(altitudes, 1, start_JD, end_JD, targets, scan, max_rate_deg_per_day).front());
+}
+
+enum class HorizonClass {
+    MayCross,
+    AlwaysAbove,
+    AlwaysBelow
+};
+
+// Classifies a period without scanning, from the range of declination it spans. The
+// geocentric altitude of a body at declination d seen from latitude p runs between
+// |p + d| - 90 (lower culmination) and 90 - |p - d| (upper culmination), and topocentric
+// parallax lowers it by at most max_parallax_deg. All angles in degrees.
+inline HorizonClass classifyHorizon(double latitude_deg, double min_declination_deg, double max_declination_deg,
+                                    double max_parallax_deg, double target_alt_deg) {
+    auto lower_culmination = [&](double dec) { return std::abs(latitude_deg + dec) - 90.0; };
+    auto upper_culmination = [&](double dec) { return 90.0 - std::abs(latitude_deg - dec); };
+
+    double lowest = -latitude_deg >= min_declination_deg && -latitude_deg <= max_declination_deg
+                        ? -90.0
+                        : std::min(lower_culmination(min_declination_deg), lower_culmination(max_declination_deg));
+    double highest = latitude_deg >= min_declination_deg && latitude_deg <= max_declination_deg
+                         ? 90.0
+                         : std::max(upper_culmination(min_declination_deg), upper_culmination(max_declination_deg));
+
+    if (lowest - max_parallax_deg > target_alt_deg) {
+        return HorizonClass::AlwaysAbove;
+    }
+    if (highest < target_alt_deg) {
+        return HorizonClass::AlwaysBelow;
+    }
+    return HorizonClass::MayCross;
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef TSUKI_JULIAN_DAY_CPP
+#define TSUKI_JULIAN_DAY_CPP
+
+#include <chrono>
+#include <cstdint>
+
+constexpr double UNIX_EPOCH_JD = 2440587.5;
+
+// A Julian day split into the JD of the UTC midnight starting it (an integer plus one half)
+// and the fraction of the day elapsed since, in [0, 1). A single double near JD 2.46e6
+// resolves about 40 us; the split form keeps the clock's full precision, and `day` converts
+// back to a calendar day exactly.
+struct JulianDate {
+    double day;
+    double fraction;
+
+    constexpr double value() const {
+        return day + fraction;
+    }
+};
+
+// Conversions between std::chrono::sys_time and Julian days, straight from the count of the
+// clock's ticks: no std::tm, no time_t and no calendar arithmetic. UTC, without leap seconds,
+// as system_clock and the rest of the tree count time.
+template <typename Duration>
+constexpr JulianDate toJulianDate(std::chrono::sys_time<Duration> time) {
+    const std::chrono::sys_days midnight = std::chrono::floor<std::chrono::days>(time);
+    const std::chrono::duration<double, std::chrono::days::period> elapsed = time - midnight;
+    return JulianDate{UNIX_EPOCH_JD + static_cast<double>(midnight.time_since_epoch().count()), elapsed.count()};
+}
+
+template <typename Duration>
+constexpr double toJulianDay(std::chrono::sys_time<Duration> time) {
+    return toJulianDate(time).value();
+}
+
+// The whole days are carried as an integer count so that only the fraction passes through
+// floating point.
+template <typename Duration = std::chrono::system_clock::duration>
+constexpr std::chrono::sys_time<Duration> fromJulianDate(const JulianDate& JD) {
+    const double days_since_epoch = JD.day - UNIX_EPOCH_JD;
+    std::int64_t whole_days = static_cast<std::int64_t>(days_since_epoch);
+    if (static_cast<double>(whole_days) > days_since_epoch) {
+        --whole_days;
+    }
+    const std::chrono::duration<double, std::chrono::days::period> rest{(days_since_epoch - static_cast<double>(whole_days)) + JD.fraction};
+    return std::chrono::sys_time<Duration>{std::chrono::duration_cast<Duration>(std::chrono::days{whole_days}) + std::chrono::floor<Duration>(rest)};
+}
+
+// The instant of a Julian day, rounded down to a whole Duration.
+template <typename Duration = std::chrono::system_clock::duration>
+constexpr std::chrono::sys_time<Duration> fromJulianDay(double JD) {
+    return fromJulianDate<Duration>(JulianDate{JD, 0.0});
+}
+
+inline double currentJulianDay() {
+    return toJulianDay(std::chrono::system_clock::now());
+}
+
+static_assert(toJulianDay(std::chrono::sys_days{std::chrono::year{2000} / std::chrono::January / 1} + std::chrono::hours{12}) == 2451545.0);
+static_assert(fromJulianDay<std::chrono::seconds>(2451545.0) ==
+              std::chrono::sys_days{std::chrono::year{2000} / std::chrono::January / 1} + std::chrono::hours{12});
+
+#endif
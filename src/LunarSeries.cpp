@@ -0,0 +1,448 @@
+#ifndef TSUKI_LUNAR_SERIES_CPP
+#define TSUKI_LUNAR_SERIES_CPP
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+#include <SimdMath.cpp>
+
+// Term sets for the lunar theory. Costs are per epoch on one x86-64 core (scalar call /
+// AVX-512 batch); errors are against Full over 1900-2100.
+//
+//   Fast      6/4/4 lon/lat/dist terms, 4 sin/cos pairs, ~120 ns / ~10 ns.
+//             lon max 1264" (rms 328"), lat max 652" (rms 211"), dist max 1193 km.
+//   Standard  22/17/36 terms, 4 sin/cos pairs, ~175 ns / ~15 ns. The original series;
+//             several of its arguments do not match the Meeus terms their coefficients
+//             come from, so it is less accurate than Fast.
+//             lon max 10278" (rms 4047"), lat max 3341" (rms 1526"), dist max 2018 km.
+//   Full      Meeus chapter 47: 59/60/46 terms with the E factor and the A1-A3 additive
+//             terms, 8 sin/cos pairs, ~380 ns / ~35 ns. Meeus gives its accuracy as about
+//             10" in longitude and 4" in latitude against ELP-2000/82.
+//
+// All tiers take UT for dynamical time, which adds up to ~40" of lunar motion today.
+enum class LunarPrecision {
+    Fast,
+    Standard,
+    Full
+};
+
+// One periodic term of a lunar series: coefficient * sin (or cos) of
+// D * D + M * M + Mp * M' + F * F, with D, M, M', F the mean elongation, solar anomaly,
+// lunar anomaly and argument of latitude.
+struct PeriodicTerm {
+    int D;
+    int M;
+    int Mp;
+    int F;
+    double coefficient;
+};
+
+constexpr int MAX_ARGUMENT_MULTIPLE = 4;
+
+// cos/sin of k * (D, M, M', F) for k = 0..MAX_ARGUMENT_MULTIPLE, and E^0..E^2 for the
+// series that scale their M terms by the eccentricity of the Earth's orbit.
+template <typename V>
+struct ArgumentMultiples {
+    V cos[4][MAX_ARGUMENT_MULTIPLE + 1];
+    V sin[4][MAX_ARGUMENT_MULTIPLE + 1];
+    V eccentricity[3];
+};
+
+// Four sin/cos evaluations per epoch; every higher multiple comes from the angle-addition
+// recurrence.
+template <typename V>
+SIMD_INLINE void makeArgumentMultiples(const V (&angles_rad)[4], ArgumentMultiples<V>& out) {
+    for (int arg = 0; arg < 4; ++arg) {
+        const V c1 = cos(angles_rad[arg]);
+        const V s1 = sin(angles_rad[arg]);
+        out.cos[arg][0] = V{} + 1.0;
+        out.sin[arg][0] = V{};
+        out.cos[arg][1] = c1;
+        out.sin[arg][1] = s1;
+        for (int k = 2; k <= MAX_ARGUMENT_MULTIPLE; ++k) {
+            out.cos[arg][k] = out.cos[arg][k - 1] * c1 - out.sin[arg][k - 1] * s1;
+            out.sin[arg][k] = out.sin[arg][k - 1] * c1 + out.cos[arg][k - 1] * s1;
+        }
+    }
+
+    out.eccentricity[0] = V{} + 1.0;
+    out.eccentricity[1] = V{} + 1.0;
+    out.eccentricity[2] = V{} + 1.0;
+}
+
+template <typename V>
+SIMD_INLINE void setEccentricity(const V& E, ArgumentMultiples<V>& out) {
+    out.eccentricity[1] = E;
+    out.eccentricity[2] = E * E;
+}
+
+constexpr int argumentMultiple(const PeriodicTerm& term, std::size_t arg) {
+    return arg == 0 ? term.D : arg == 1 ? term.M : arg == 2 ? term.Mp : term.F;
+}
+
+constexpr std::size_t firstArgument(const PeriodicTerm& term) {
+    return term.D != 0 ? 0 : term.M != 0 ? 1 : term.Mp != 0 ? 2 : 3;
+}
+
+// Multiplies (re, im) by exp(i * k * argument) for the term's k on argument Arg.
+// The first non-zero argument initializes the phasor instead of multiplying into it.
+template <const auto& Terms, std::size_t I, std::size_t Arg, typename V>
+SIMD_INLINE void rotateByArgument(const ArgumentMultiples<V>& args, V& re, V& im) {
+    constexpr int k = argumentMultiple(Terms[I], Arg);
+    constexpr std::size_t first = firstArgument(Terms[I]);
+
+    if constexpr (k != 0) {
+        constexpr int n = k < 0 ? -k : k;
+        const V& c = args.cos[Arg][n];
+        V s = args.sin[Arg][n];
+        if constexpr (k < 0) {
+            s = -s;
+        }
+
+        if constexpr (Arg == first) {
+            re = c;
+            im = s;
+        } else {
+            const V re_next = re * c - im * s;
+            im = re * s + im * c;
+            re = re_next;
+        }
+    }
+}
+
+template <const auto& Terms, std::size_t I, bool Cosine, bool Eccentricity, typename V>
+SIMD_INLINE V periodicTerm(const ArgumentMultiples<V>& args) {
+    V re{}, im{};
+    rotateByArgument<Terms, I, 0>(args, re, im);
+    rotateByArgument<Terms, I, 1>(args, re, im);
+    rotateByArgument<Terms, I, 2>(args, re, im);
+    rotateByArgument<Terms, I, 3>(args, re, im);
+
+    constexpr int m = Terms[I].M < 0 ? -Terms[I].M : Terms[I].M;
+    V value;
+    if constexpr (Cosine) {
+        value = Terms[I].coefficient * re;
+    } else {
+        value = Terms[I].coefficient * im;
+    }
+    if constexpr (Eccentricity && m != 0) {
+        value = value * args.eccentricity[m];
+    }
+    return value;
+}
+
+template <const auto& Terms, bool Cosine, bool Eccentricity, typename V, std::size_t... I>
+SIMD_INLINE V sumPeriodicTerms(const ArgumentMultiples<V>& args, std::index_sequence<I...>) {
+    V sum{};
+    ((sum += periodicTerm<Terms, I, Cosine, Eccentricity>(args)), ...);
+    return sum;
+}
+
+// The table is a template argument, so every term is unrolled with its multipliers known
+// at compile time and zero multipliers cost nothing.
+template <const auto& Terms, bool Eccentricity = false, typename V>
+SIMD_INLINE V evaluateSineSeries(const ArgumentMultiples<V>& args) {
+    return sumPeriodicTerms<Terms, false, Eccentricity>(args, std::make_index_sequence<Terms.size()>{});
+}
+
+template <const auto& Terms, bool Eccentricity = false, typename V>
+SIMD_INLINE V evaluateCosineSeries(const ArgumentMultiples<V>& args) {
+    return sumPeriodicTerms<Terms, true, Eccentricity>(args, std::make_index_sequence<Terms.size()>{});
+}
+
+// Fast: the largest terms of each Meeus series, on the same mean arguments as Standard.
+// Longitude and latitude terms in degrees, distance terms in km.
+constexpr std::array<PeriodicTerm, 6> FAST_LUNAR_LONGITUDE_TERMS = {{
+    { 0,  0,  1,  0,  6.288774},
+    { 2,  0, -1,  0,  1.274027},
+    { 2,  0,  0,  0,  0.658314},
+    { 0,  0,  2,  0,  0.213618},
+    { 0,  1,  0,  0, -0.185116},
+    { 0,  0,  0,  2, -0.114332},
+}};
+
+constexpr std::array<PeriodicTerm, 4> FAST_LUNAR_LATITUDE_TERMS = {{
+    { 0,  0,  0,  1,  5.128122},
+    { 0,  0,  1,  1,  0.280602},
+    { 0,  0,  1, -1,  0.277693},
+    { 2,  0,  0, -1,  0.173237},
+}};
+
+constexpr double FAST_LUNAR_MEAN_DISTANCE_KM = 385000.56;
+
+constexpr std::array<PeriodicTerm, 4> FAST_LUNAR_DISTANCE_TERMS = {{
+    { 0,  0,  1,  0, -20905.355},
+    { 2,  0, -1,  0,  -3699.111},
+    { 2,  0,  0,  0,  -2955.968},
+    { 0,  0,  2,  0,   -569.925},
+}};
+
+// Standard: the original truncated series. Longitude and latitude terms in degrees,
+// distance terms in km.
+constexpr std::array<PeriodicTerm, 22> STANDARD_LUNAR_LONGITUDE_TERMS = {{
+    { 0,  0,  1,  0,  6.28875},
+    { 2,  0,  0,  0,  1.27401},
+    { 0,  0,  0,  2,  0.65831},
+    { 0,  1,  0,  0, -0.18581},
+    { 0,  0,  1,  2, -0.11433},
+    { 2,  0, -1,  0,  0.05877},
+    { 2,  0,  1,  0,  0.05730},
+    { 0,  1,  0,  2,  0.05322},
+    { 0,  0, -1,  2,  0.04620},
+    { 2, -1,  0,  0,  0.04092},
+    { 0,  1,  1,  0,  0.03044},
+    { 2,  0,  0, -2,  0.01526},
+    { 0, -1,  1,  0,  0.01130},
+    { 0, -1,  0,  2,  0.01024},
+    { 2,  1,  0,  0, -0.00914},
+    { 2,  0,  0,  2,  0.00422},
+    { 2,  0,  0, -3,  0.00386},
+    { 0,  0,  3,  0,  0.00366},
+    { 0,  2,  0,  0,  0.00293},
+    {-2,  0,  2,  0,  0.00276},
+    { 2,  0,  2,  0,  0.00252},
+    { 2, -1,  1,  0,  0.00224},
+}};
+
+constexpr std::array<PeriodicTerm, 17> STANDARD_LUNAR_LATITUDE_TERMS = {{
+    { 0,  0,  0,  1,  5.12819},
+    { 0,  0,  1,  1,  0.28060},
+    { 0,  0, -1,  1,  0.27769},
+    { 0,  1,  0,  1,  0.17320},
+    { 2,  0,  0,  1,  0.05538},
+    { 2,  0,  0, -1,  0.04627},
+    { 2,  0, -1,  1,  0.03257},
+    { 2,  1,  0, -1,  0.01633},
+    { 2,  0,  1,  1,  0.00809},
+    { 0,  0,  2,  1,  0.00769},
+    { 2,  0, -1,  2,  0.00755},
+    { 2,  1,  0,  1,  0.00705},
+    { 2, -1,  0,  1,  0.00583},
+    { 2,  0,  0,  2,  0.00517},
+    { 2,  1,  0, -2,  0.00412},
+    { 2,  0,  1,  2,  0.00388},
+    { 2,  0,  1,  2,  0.00277},
+}};
+
+constexpr double STANDARD_LUNAR_MEAN_DISTANCE_KM = 385000.0;
+
+constexpr std::array<PeriodicTerm, 36> STANDARD_LUNAR_DISTANCE_TERMS = {{
+    { 0,  0,  1,  0, -20905.0},
+    { 2,  0, -1,  0,  -3699.0},
+    { 2,  0,  0,  0,  -2956.0},
+    { 0,  0,  0,  2,   -569.0},
+    { 2,  0,  0, -2,    246.0},
+    { 0,  1,  1,  0,    209.0},
+    { 0,  1,  0,  0,    105.0},
+    { 0, -1,  1,  0,   -103.0},
+    { 2,  0,  1,  0,    -57.0},
+    { 0,  0,  1,  2,    -48.0},
+    { 2, -1, -1,  0,     46.0},
+    { 2,  0,  1,  0,     38.0},
+    { 2,  0,  1,  1,    -30.0},
+    {-2,  0,  1,  0,    -24.0},
+    { 2,  0,  0, -1,    -22.0},
+    { 0,  0,  1, -2,     15.0},
+    { 2,  0,  1,  1,    -13.0},
+    { 2,  1,  0,  0,    -12.0},
+    { 0,  1,  0, -2,     10.0},
+    { 2,  1,  0,  1,      8.0},
+    { 0,  0,  1,  1,      7.0},
+    { 2,  1,  0, -1,     -6.0},
+    {-2,  0,  1,  2,     -5.0},
+    { 2,  0,  1, -1,     -4.0},
+    { 2,  1,  1,  0,      4.0},
+    { 2, -2,  0,  0,     -4.0},
+    {-2, -1,  1,  0,     -3.0},
+    { 0,  1,  0, -1,     -3.0},
+    { 2,  0,  0,  2,     -3.0},
+    { 0,  1,  1, -1,      3.0},
+    { 0,  1,  0,  2,     -3.0},
+    { 2, -1, -1,  0,     -3.0},
+    { 2, -1,  1,  0,      3.0},
+    { 0,  1,  1,  1,      3.0},
+    {-2,  0,  1,  1,     -3.0},
+    { 2,  0, -1, -1,     -2.0},
+}};
+
+// Meeus, Astronomical Algorithms, chapter 47, tables 47.A and 47.B. Longitude and
+// latitude terms in 1e-6 degrees, distance terms in 1e-3 km. Terms with M are scaled
+// by the eccentricity factor E^|M|.
+constexpr std::array<PeriodicTerm, 59> MEEUS_LUNAR_LONGITUDE_TERMS = {{
+    { 0,  0,  1,  0, 6288774.0},
+    { 2,  0, -1,  0, 1274027.0},
+    { 2,  0,  0,  0,  658314.0},
+    { 0,  0,  2,  0,  213618.0},
+    { 0,  1,  0,  0, -185116.0},
+    { 0,  0,  0,  2, -114332.0},
+    { 2,  0, -2,  0,   58793.0},
+    { 2, -1, -1,  0,   57066.0},
+    { 2,  0,  1,  0,   53322.0},
+    { 2, -1,  0,  0,   45758.0},
+    { 0,  1, -1,  0,  -40923.0},
+    { 1,  0,  0,  0,  -34720.0},
+    { 0,  1,  1,  0,  -30383.0},
+    { 2,  0,  0, -2,   15327.0},
+    { 0,  0,  1,  2,  -12528.0},
+    { 0,  0,  1, -2,   10980.0},
+    { 4,  0, -1,  0,   10675.0},
+    { 0,  0,  3,  0,   10034.0},
+    { 4,  0, -2,  0,    8548.0},
+    { 2,  1, -1,  0,   -7888.0},
+    { 2,  1,  0,  0,   -6766.0},
+    { 1,  0, -1,  0,   -5163.0},
+    { 1,  1,  0,  0,    4987.0},
+    { 2, -1,  1,  0,    4036.0},
+    { 2,  0,  2,  0,    3994.0},
+    { 4,  0,  0,  0,    3861.0},
+    { 2,  0, -3,  0,    3665.0},
+    { 0,  1, -2,  0,   -2689.0},
+    { 2,  0, -1,  2,   -2602.0},
+    { 2, -1, -2,  0,    2390.0},
+    { 1,  0,  1,  0,   -2348.0},
+    { 2, -2,  0,  0,    2236.0},
+    { 0,  1,  2,  0,   -2120.0},
+    { 0,  2,  0,  0,   -2069.0},
+    { 2, -2, -1,  0,    2048.0},
+    { 2,  0,  1, -2,   -1773.0},
+    { 2,  0,  0,  2,   -1595.0},
+    { 4, -1, -1,  0,    1215.0},
+    { 0,  0,  2,  2,   -1110.0},
+    { 3,  0, -1,  0,    -892.0},
+    { 2,  1,  1,  0,    -810.0},
+    { 4, -1, -2,  0,     759.0},
+    { 0,  2, -1,  0,    -713.0},
+    { 2,  2, -1,  0,    -700.0},
+    { 2,  1, -2,  0,     691.0},
+    { 2, -1,  0, -2,     596.0},
+    { 4,  0,  1,  0,     549.0},
+    { 0,  0,  4,  0,     537.0},
+    { 4, -1,  0,  0,     520.0},
+    { 1,  0, -2,  0,    -487.0},
+    { 2,  1,  0, -2,    -399.0},
+    { 0,  0,  2, -2,    -381.0},
+    { 1,  1,  1,  0,     351.0},
+    { 3,  0, -2,  0,    -340.0},
+    { 4,  0, -3,  0,     330.0},
+    { 2, -1,  2,  0,     327.0},
+    { 0,  2,  1,  0,    -323.0},
+    { 1,  1, -1,  0,     299.0},
+    { 2,  0,  3,  0,     294.0},
+}};
+
+constexpr std::array<PeriodicTerm, 60> MEEUS_LUNAR_LATITUDE_TERMS = {{
+    { 0,  0,  0,  1, 5128122.0},
+    { 0,  0,  1,  1,  280602.0},
+    { 0,  0,  1, -1,  277693.0},
+    { 2,  0,  0, -1,  173237.0},
+    { 2,  0, -1,  1,   55413.0},
+    { 2,  0, -1, -1,   46271.0},
+    { 2,  0,  0,  1,   32573.0},
+    { 0,  0,  2,  1,   17198.0},
+    { 2,  0,  1, -1,    9266.0},
+    { 0,  0,  2, -1,    8822.0},
+    { 2, -1,  0, -1,    8216.0},
+    { 2,  0, -2, -1,    4324.0},
+    { 2,  0,  1,  1,    4200.0},
+    { 2,  1,  0, -1,   -3359.0},
+    { 2, -1, -1,  1,    2463.0},
+    { 2, -1,  0,  1,    2211.0},
+    { 2, -1, -1, -1,    2065.0},
+    { 0,  1, -1, -1,   -1870.0},
+    { 4,  0, -1, -1,    1828.0},
+    { 0,  1,  0,  1,   -1794.0},
+    { 0,  0,  0,  3,   -1749.0},
+    { 0,  1, -1,  1,   -1565.0},
+    { 1,  0,  0,  1,   -1491.0},
+    { 0,  1,  1,  1,   -1475.0},
+    { 0,  1,  1, -1,   -1410.0},
+    { 0,  1,  0, -1,   -1344.0},
+    { 1,  0,  0, -1,   -1335.0},
+    { 0,  0,  3,  1,    1107.0},
+    { 4,  0,  0, -1,    1021.0},
+    { 4,  0, -1,  1,     833.0},
+    { 0,  0,  1, -3,     777.0},
+    { 4,  0, -2,  1,     671.0},
+    { 2,  0,  0, -3,     607.0},
+    { 2,  0,  2, -1,     596.0},
+    { 2, -1,  1, -1,     491.0},
+    { 2,  0, -2,  1,    -451.0},
+    { 0,  0,  3, -1,     439.0},
+    { 2,  0,  2,  1,     422.0},
+    { 2,  0, -3, -1,     421.0},
+    { 2,  1, -1,  1,    -366.0},
+    { 2,  1,  0,  1,    -351.0},
+    { 4,  0,  0,  1,     331.0},
+    { 2, -1,  1,  1,     315.0},
+    { 2, -2,  0, -1,     302.0},
+    { 0,  0,  1,  3,    -283.0},
+    { 2,  1,  1, -1,    -229.0},
+    { 1,  1,  0, -1,     223.0},
+    { 1,  1,  0,  1,     223.0},
+    { 0,  1, -2, -1,    -220.0},
+    { 2,  1, -1, -1,    -220.0},
+    { 1,  0,  1,  1,    -185.0},
+    { 2, -1, -2, -1,     181.0},
+    { 0,  1,  2,  1,    -177.0},
+    { 4,  0, -2, -1,     176.0},
+    { 4, -1, -1, -1,     166.0},
+    { 1,  0,  1, -1,    -164.0},
+    { 4,  0,  1, -1,     132.0},
+    { 1,  0, -1, -1,    -119.0},
+    { 4, -1,  0, -1,     115.0},
+    { 2, -2,  0,  1,     107.0},
+}};
+
+constexpr double MEEUS_LUNAR_MEAN_DISTANCE_KM = 385000.56;
+
+constexpr std::array<PeriodicTerm, 46> MEEUS_LUNAR_DISTANCE_TERMS = {{
+    { 0,  0,  1,  0, -20905355.0},
+    { 2,  0, -1,  0,  -3699111.0},
+    { 2,  0,  0,  0,  -2955968.0},
+    { 0,  0,  2,  0,   -569925.0},
+    { 0,  1,  0,  0,     48888.0},
+    { 0,  0,  0,  2,     -3149.0},
+    { 2,  0, -2,  0,    246158.0},
+    { 2, -1, -1,  0,   -152138.0},
+    { 2,  0,  1,  0,   -170733.0},
+    { 2, -1,  0,  0,   -204586.0},
+    { 0,  1, -1,  0,   -129620.0},
+    { 1,  0,  0,  0,    108743.0},
+    { 0,  1,  1,  0,    104755.0},
+    { 2,  0,  0, -2,     10321.0},
+    { 0,  0,  1, -2,     79661.0},
+    { 4,  0, -1,  0,    -34782.0},
+    { 0,  0,  3,  0,    -23210.0},
+    { 4,  0, -2,  0,    -21636.0},
+    { 2,  1, -1,  0,     24208.0},
+    { 2,  1,  0,  0,     30824.0},
+    { 1,  0, -1,  0,     -8379.0},
+    { 1,  1,  0,  0,    -16675.0},
+    { 2, -1,  1,  0,    -12831.0},
+    { 2,  0,  2,  0,    -10445.0},
+    { 4,  0,  0,  0,    -11650.0},
+    { 2,  0, -3,  0,     14403.0},
+    { 0,  1, -2,  0,     -7003.0},
+    { 2, -1, -2,  0,     10056.0},
+    { 1,  0,  1,  0,      6322.0},
+    { 2, -2,  0,  0,     -9884.0},
+    { 0,  1,  2,  0,      5751.0},
+    { 2, -2, -1,  0,     -4950.0},
+    { 2,  0,  1, -2,      4130.0},
+    { 4, -1, -1,  0,     -3958.0},
+    { 3,  0, -1,  0,      3258.0},
+    { 2,  1,  1,  0,      2616.0},
+    { 4, -1, -2,  0,     -1897.0},
+    { 0,  2, -1,  0,     -2117.0},
+    { 2,  2, -1,  0,      2354.0},
+    { 4,  0,  1,  0,     -1423.0},
+    { 0,  0,  4,  0,     -1117.0},
+    { 4, -1,  0,  0,     -1571.0},
+    { 1,  0, -2,  0,     -1739.0},
+    { 0,  0,  2, -2,     -4421.0},
+    { 0,  2,  1,  0,      1165.0},
+    { 2,  0, -1, -2,      8752.0},
+}};
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef TSUKI_MOON_EVENTS_CPP
+#define TSUKI_MOON_EVENTS_CPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <Generator.cpp>
+#include <HorizonScan.cpp>
+#include <LunarTrack.cpp>
+#include <PhaseEvents.cpp>
+#include <RiseSetEngine.cpp>
+
+enum class MoonEventType {
+    Rise,
+    Set,
+    Transit,
+    NewMoon,
+    FirstQuarter,
+    FullMoon,
+    LastQuarter
+};
+
+struct MoonEvent {
+    MoonEventType type;
+    double JD;
+};
+
+inline const char* moonEventName(MoonEventType type) {
+    switch (type) {
+        case MoonEventType::Rise:
+            return "Moonrise";
+        case MoonEventType::Set:
+            return "Moonset";
+        case MoonEventType::Transit:
+            return "Transit";
+        default:
+            return principalPhaseName(static_cast<PrincipalPhase>(static_cast<int>(type) - static_cast<int>(MoonEventType::NewMoon)));
+    }
+}
+
+namespace {
+
+// Upper transits (local hour angle rising through zero) in [start_JD, end_JD]. The hour angle
+// advances ~0.25 rad per hourly sample, so a negative-to-positive change between samples
+// within +-pi/2 is a transit rather than the wrap at +-pi.
+void findTransits(const LunarTrack& track, double longitude_deg, double start_JD, double end_JD, std::vector<double>& transits) {
+    const double STEP_JD = 1.0 / 24.0;
+    const double TOLERANCE_JD = 1.0 / (24.0 * 60.0 * 60.0);
+    auto hour_angle = [&](double JD) {
+        return getLocalHourAngle(track.at(JD), JD, longitude_deg);
+    };
+
+    double prev_JD = start_JD;
+    double prev_angle = hour_angle(prev_JD);
+    while (prev_JD < end_JD) {
+        double current_JD = std::min(prev_JD + STEP_JD, end_JD);
+        double current_angle = hour_angle(current_JD);
+        if (prev_angle < 0.0 && current_angle >= 0.0 && current_angle - prev_angle < PI / 2.0) {
+            transits.push_back(findRootBrent(hour_angle, prev_JD, current_JD, prev_angle, current_angle, TOLERANCE_JD));
+        }
+        prev_JD = current_JD;
+        prev_angle = current_angle;
+    }
+}
+
+}
+
+// Moonrise, moonset, upper transit and principal phase events for `observer` from from_JD
+// up to to_JD (unbounded by default), in time order. Work is done one CHUNK_DAYS window at a
+// time as the consumer advances, so taking only the next moonrise costs at most the day it
+// falls in, and a scan over years runs in constant memory.
+inline Generator<MoonEvent> moonEvents(ObserverSite observer, double from_JD,
+                                       double to_JD = std::numeric_limits<double>::infinity(),
+                                       HorizonScan horizon_scan = HorizonScan::Adaptive) {
+    constexpr double CHUNK_DAYS = 1.0;
+
+    // Principal phases are solved only once their mean time (within a day of the true one)
+    // comes within reach of the current chunk.
+    constexpr double MAX_MEAN_PHASE_OFFSET_DAYS = 1.0;
+    long long quarter = static_cast<long long>(std::floor((from_JD - MEAN_NEW_MOON_JD_2000) / SYNODIC_MONTH_DAYS * 4.0));
+    std::vector<PhaseEvent> pending_phases;
+
+    std::vector<MoonEvent> chunk_events;
+    std::vector<double> transits;
+    for (double chunk_start = from_JD; chunk_start < to_JD; chunk_start += CHUNK_DAYS) {
+        const double chunk_end = std::min(chunk_start + CHUNK_DAYS, to_JD);
+
+        const LunarTrack track(chunk_start, chunk_end);
+        auto altitude = [&](double JD) {
+            return getTopocentricAltitude(makeTopocentricEpoch(track.at(JD), JD), observer.geometry);
+        };
+        HorizonCrossings crossings = findHorizonCrossings(altitude, chunk_start, chunk_end, HORIZON_ALT_DEG, horizon_scan);
+
+        transits.clear();
+        findTransits(track, observer.longitude, chunk_start, chunk_end, transits);
+
+        chunk_events.clear();
+        for (double JD : crossings.rises) {
+            chunk_events.push_back(MoonEvent{MoonEventType::Rise, JD});
+        }
+        for (double JD : crossings.sets) {
+            chunk_events.push_back(MoonEvent{MoonEventType::Set, JD});
+        }
+        for (double JD : transits) {
+            chunk_events.push_back(MoonEvent{MoonEventType::Transit, JD});
+        }
+        for (;; ++quarter) {
+            double mean_JD = MEAN_NEW_MOON_JD_2000 + SYNODIC_MONTH_DAYS * static_cast<double>(quarter) / 4.0;
+            if (mean_JD - MAX_MEAN_PHASE_OFFSET_DAYS >= chunk_end) {
+                break;
+            }
+            PrincipalPhase phase = static_cast<PrincipalPhase>(((quarter % 4) + 4) % 4);
+            double JD = solvePhaseEvent(mean_JD, phase);
+            if (JD >= from_JD) {
+                pending_phases.push_back(PhaseEvent{phase, JD});
+            }
+        }
+        while (!pending_phases.empty() && pending_phases.front().JD < chunk_end) {
+            const PhaseEvent& event = pending_phases.front();
+            chunk_events.push_back(MoonEvent{static_cast<MoonEventType>(static_cast<int>(MoonEventType::NewMoon) + static_cast<int>(event.phase)), event.JD});
+            pending_phases.erase(pending_phases.begin());
+        }
+        std::sort(chunk_events.begin(), chunk_events.end(), [](const MoonEvent& a, const MoonEvent& b) { return a.JD < b.JD; });
+
+        for (const MoonEvent& event : chunk_events) {
+            co_yield event;
+        }
+    }
+}
+
+#endif
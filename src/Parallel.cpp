@@ -0,0 +1,29 @@
+#ifndef TSUKI_PARALLEL_CPP
+#define TSUKI_PARALLEL_CPP
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// Runs body(first, end) over `count` items split into contiguous ranges, one per thread
+// (threads = 0: one per hardware thread).
+template <typename Body>
+void parallelFor(int count, unsigned threads, Body&& body) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min<unsigned>(threads, static_cast<unsigned>(std::max(count, 1)));
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (unsigned t = 0; t < threads; ++t) {
+        int first = static_cast<int>(static_cast<long long>(count) * t / threads);
+        int end = static_cast<int>(static_cast<long long>(count) * (t + 1) / threads);
+        workers.emplace_back([&body, first, end] { body(first, end); });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef TSUKI_PHASE_EVENTS_CPP
+#define TSUKI_PHASE_EVENTS_CPP
+
+#include <cmath>
+#include <vector>
+
+#include <EphemerisFile.cpp>
+
+enum class PrincipalPhase {
+    NewMoon,
+    FirstQuarter,
+    FullMoon,
+    LastQuarter
+};
+
+struct PhaseEvent {
+    PrincipalPhase phase;
+    double JD;
+};
+
+inline const char* principalPhaseName(PrincipalPhase phase) {
+    switch (phase) {
+        case PrincipalPhase::NewMoon:
+            return "New Moon";
+        case PrincipalPhase::FirstQuarter:
+            return "First Quarter";
+        case PrincipalPhase::FullMoon:
+            return "Full Moon";
+        default:
+            return "Last Quarter";
+    }
+}
+
+// Ecliptic longitude of the Moon minus that of the Sun, in degrees in (-180, 180]: 0 at new
+// moon, 90 at first quarter, 180 at full moon and -90 at last quarter. Nutation shifts both
+// longitudes equally, so mean and apparent elongation agree.
+inline double getLunarElongation(const LunarCoords& moon, const SolarCoords& sun) {
+    return remainder(moon.eclipticLongitude - sun.eclipticLongitude, 360.0);
+}
+
+inline double getLunarElongation(double JD) {
+    return getLunarElongation(ephemerisLunarCoordinates(JD), ephemerisSolarCoordinates(JD));
+}
+
+// Mean synodic month and the mean new moon of 2000 January 6 (Meeus 49.1), used only to
+// seed the solver.
+constexpr double SYNODIC_MONTH_DAYS = 29.530588861;
+constexpr double MEAN_NEW_MOON_JD_2000 = 2451550.09766;
+
+// Newton's method on the elongation from a starting time within a few days of the event.
+// The derivative is a central difference over DERIVATIVE_STEP_JD, which is exact to well
+// under the tolerance for a function this smooth. Converges in 3-4 iterations from the mean
+// phase, to ~0.1 s.
+inline double solvePhaseEvent(double guess_JD, PrincipalPhase phase) {
+    constexpr double DERIVATIVE_STEP_JD = 1.0 / 24.0;
+    constexpr double TOLERANCE_JD = 1e-6;
+    constexpr int MAX_ITERATIONS = 10;
+
+    const double target_deg = 90.0 * static_cast<int>(phase);
+    auto offset = [&](double JD) {
+        return remainder(getLunarElongation(JD) - target_deg, 360.0);
+    };
+
+    double JD = guess_JD;
+    for (int i = 0; i < MAX_ITERATIONS; ++i) {
+        double rate = remainder(offset(JD + DERIVATIVE_STEP_JD) - offset(JD - DERIVATIVE_STEP_JD), 360.0) / (2.0 * DERIVATIVE_STEP_JD);
+        double step = offset(JD) / rate;
+        JD -= step;
+        if (std::abs(step) < TOLERANCE_JD) {
+            break;
+        }
+    }
+    return JD;
+}
+
+// Every principal phase in [start_JD, end_JD), in time order.
+inline std::vector<PhaseEvent> findPhaseEvents(double start_JD, double end_JD) {
+    std::vector<PhaseEvent> events;
+    // Mean and true phases differ by under a day, so start one quarter early.
+    long long quarter = static_cast<long long>(std::floor((start_JD - MEAN_NEW_MOON_JD_2000) / SYNODIC_MONTH_DAYS * 4.0)) - 1;
+    for (;; ++quarter) {
+        double mean_JD = MEAN_NEW_MOON_JD_2000 + SYNODIC_MONTH_DAYS * static_cast<double>(quarter) / 4.0;
+        if (mean_JD > end_JD + 1.0) {
+            break;
+        }
+        PrincipalPhase phase = static_cast<PrincipalPhase>(((quarter % 4) + 4) % 4);
+        double JD = solvePhaseEvent(mean_JD, phase);
+        if (JD >= start_JD && JD < end_JD) {
+            events.push_back(PhaseEvent{phase, JD});
+        }
+    }
+    return events;
+}
+
+#endif
@@ -0,0 +1,257 @@
+#ifndef TSUKI_RASTER_CPP
+#define TSUKI_RASTER_CPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <HorizonScan.cpp>
+#include <LunarTrack.cpp>
+#include <Parallel.cpp>
+
+// Cell-centred global latitude/longitude grid, row 0 at the north pole and column 0 at
+// 180 deg west.
+struct RasterGrid {
+    double resolutionDeg;
+
+    int width() const {
+        return static_cast<int>(std::lround(360.0 / resolutionDeg));
+    }
+
+    int height() const {
+        return static_cast<int>(std::lround(180.0 / resolutionDeg));
+    }
+
+    double latitude(int row) const {
+        return 90.0 - (row + 0.5) * resolutionDeg;
+    }
+
+    double longitude(int column) const {
+        return -180.0 + (column + 0.5) * resolutionDeg;
+    }
+};
+
+// The raster kernels use the vector form of the same spherical-Earth topocentric model as
+// getTopocentricAltitude. With the Moon at r Earth radii, hour angle H and declination d,
+// and k = r (cos d cos lat cos H + sin d sin lat), the topocentric altitude h satisfies
+//     sin h = (k - 1) / sqrt(r^2 - 2k + 1).
+// cos H = cos(GMST - RA) cos lon - sin(GMST - RA) sin lon, so per epoch only a handful of
+// scalars change and the per-cell work is multiply-adds and a square root, which the
+// compiler vectorizes across each row.
+struct RasterEpoch {
+    double cosHourAngle;
+    double sinHourAngle;
+    double rCosDeclination;
+    double rSinDeclination;
+    double rSquaredPlusOne;
+};
+
+struct RasterColumns {
+    std::vector<double> cosLongitude;
+    std::vector<double> sinLongitude;
+
+    explicit RasterColumns(const RasterGrid& grid) {
+        for (int column = 0; column < grid.width(); ++column) {
+            double lon_rad = degreesToRadians(grid.longitude(column));
+            cosLongitude.push_back(cos(lon_rad));
+            sinLongitude.push_back(sin(lon_rad));
+        }
+    }
+};
+
+inline RasterEpoch makeRasterEpoch(const EquatorialCoords& moon, double JD_utc) {
+    double r = moon.distance / EARTH_RADIUS_KM;
+    double greenwich_hour_angle = degreesToRadians(getGMST(JD_utc)) - moon.rightAscension;
+    return RasterEpoch{cos(greenwich_hour_angle), sin(greenwich_hour_angle),
+                       r * cos(moon.declination), r * sin(moon.declination), r * r + 1.0};
+}
+
+inline double rasterSinAltitude(const RasterEpoch& epoch, double sin_lat, double cos_lat, double cos_lon, double sin_lon) {
+    double cos_hour_angle = epoch.cosHourAngle * cos_lon - epoch.sinHourAngle * sin_lon;
+    double k = epoch.rCosDeclination * cos_lat * cos_hour_angle + epoch.rSinDeclination * sin_lat;
+    return (k - 1.0) / std::sqrt(epoch.rSquaredPlusOne - 2.0 * k);
+}
+
+// sin(altitude) for every column of one row.
+inline void rasterRowSinAltitude(const RasterEpoch& epoch, const RasterColumns& columns, double latitude_deg, double* out) {
+    const double lat_rad = degreesToRadians(latitude_deg);
+    const double sin_lat = sin(lat_rad);
+    const double cos_lat = cos(lat_rad);
+    const std::size_t width = columns.cosLongitude.size();
+    const double* cos_lon = columns.cosLongitude.data();
+    const double* sin_lon = columns.sinLongitude.data();
+    for (std::size_t column = 0; column < width; ++column) {
+        out[column] = rasterSinAltitude(epoch, sin_lat, cos_lat, cos_lon[column], sin_lon[column]);
+    }
+}
+
+// Whether each column of one row is below a negative target altitude, without the square
+// root: sin h < sin_target < 0 exactly when k - 1 < 0 and (k - 1)^2 > sin_target^2 (r^2 - 2k + 1).
+// Mask-only arithmetic, so the loop vectorizes.
+inline void rasterRowBelow(const RasterEpoch& epoch, const RasterColumns& columns, double sin_lat, double cos_lat,
+                           double sin_target_squared, std::int64_t* out) {
+    const std::size_t width = columns.cosLongitude.size();
+    const double* cos_lon = columns.cosLongitude.data();
+    const double* sin_lon = columns.sinLongitude.data();
+    const double a = epoch.rCosDeclination * cos_lat;
+    const double b = epoch.rSinDeclination * sin_lat;
+    const double cos_hour_angle = epoch.cosHourAngle;
+    const double sin_hour_angle = epoch.sinHourAngle;
+    const double r_squared_plus_one = epoch.rSquaredPlusOne;
+    for (std::size_t column = 0; column < width; ++column) {
+        double k = a * (cos_hour_angle * cos_lon[column] - sin_hour_angle * sin_lon[column]) + b;
+        double k_minus_one = k - 1.0;
+        out[column] = k_minus_one < 0.0 && k_minus_one * k_minus_one > sin_target_squared * (r_squared_plus_one - 2.0 * k) ? 1 : 0;
+    }
+}
+
+// Topocentric lunar altitude in degrees for every cell, row-major.
+inline std::vector<float> altitudeRaster(const RasterGrid& grid, double JD_utc, unsigned threads = 0) {
+    const int width = grid.width();
+    const RasterColumns columns(grid);
+    const RasterEpoch epoch = makeRasterEpoch(getApparentLunarEquatorial(JD_utc), JD_utc);
+
+    std::vector<float> raster(static_cast<std::size_t>(width) * grid.height());
+    parallelFor(grid.height(), threads, [&](int first_row, int end_row) {
+        std::vector<double> row_values(width);
+        for (int row = first_row; row < end_row; ++row) {
+            rasterRowSinAltitude(epoch, columns, grid.latitude(row), row_values.data());
+            float* out = &raster[static_cast<std::size_t>(row) * width];
+            for (int column = 0; column < width; ++column) {
+                out[column] = static_cast<float>(radiansToDegrees(asin(row_values[column])));
+            }
+        }
+    });
+    return raster;
+}
+
+// First moonrise and moonset in [start_JD, start_JD + days] for every cell, in hours after
+// start_JD (NaN where there is none), row-major.
+struct RiseSetRaster {
+    std::vector<float> riseHours;
+    std::vector<float> setHours;
+};
+
+// Each row is scanned densely on the DENSE_STEP_JD grid, vectorized across columns with
+// rasterRowBelow; crossings are then refined per cell with findRootBrent on the
+// interpolated track.
+inline RiseSetRaster riseSetRaster(const RasterGrid& grid, double start_JD, double days = 1.0, unsigned threads = 0) {
+    const int width = grid.width();
+    const double end_JD = start_JD + days;
+    const RasterColumns columns(grid);
+    const LunarTrack track(start_JD, end_JD);
+    static_assert(HORIZON_ALT_DEG < 0.0, "rasterRowBelow assumes a target below the horizon");
+    const double sin_target = sin(degreesToRadians(HORIZON_ALT_DEG));
+
+    const std::size_t epoch_count = static_cast<std::size_t>(std::ceil(days / DENSE_STEP_JD)) + 1;
+    std::vector<double> epoch_JDs(epoch_count);
+    std::vector<RasterEpoch> epochs(epoch_count);
+    for (std::size_t e = 0; e < epoch_count; ++e) {
+        epoch_JDs[e] = std::min(start_JD + static_cast<double>(e) * DENSE_STEP_JD, end_JD);
+        epochs[e] = makeRasterEpoch(track.at(epoch_JDs[e]), epoch_JDs[e]);
+    }
+
+    const std::size_t cells = static_cast<std::size_t>(width) * grid.height();
+    RiseSetRaster raster;
+    raster.riseHours.assign(cells, std::numeric_limits<float>::quiet_NaN());
+    raster.setHours.assign(cells, std::numeric_limits<float>::quiet_NaN());
+
+    parallelFor(grid.height(), threads, [&](int first_row, int end_row) {
+        constexpr int NONE = -1;
+        std::vector<std::int64_t> previous(width);
+        std::vector<std::int64_t> current(width);
+        std::vector<int> rise_bracket(width);
+        std::vector<int> set_bracket(width);
+
+        for (int row = first_row; row < end_row; ++row) {
+            const double lat_rad = degreesToRadians(grid.latitude(row));
+            const double sin_lat = sin(lat_rad);
+            const double cos_lat = cos(lat_rad);
+
+            std::fill(rise_bracket.begin(), rise_bracket.end(), NONE);
+            std::fill(set_bracket.begin(), set_bracket.end(), NONE);
+            rasterRowBelow(epochs[0], columns, sin_lat, cos_lat, sin_target * sin_target, previous.data());
+
+            for (std::size_t e = 1; e < epochs.size(); ++e) {
+                rasterRowBelow(epochs[e], columns, sin_lat, cos_lat, sin_target * sin_target, current.data());
+                for (int column = 0; column < width; ++column) {
+                    if (previous[column] != current[column]) {
+                        int& bracket = current[column] ? set_bracket[column] : rise_bracket[column];
+                        if (bracket == NONE) {
+                            bracket = static_cast<int>(e);
+                        }
+                    }
+                }
+                std::swap(previous, current);
+            }
+
+            for (int column = 0; column < width; ++column) {
+                const double cos_lon = columns.cosLongitude[column];
+                const double sin_lon = columns.sinLongitude[column];
+                auto above_target = [&](double JD) {
+                    return rasterSinAltitude(makeRasterEpoch(track.at(JD), JD), sin_lat, cos_lat, cos_lon, sin_lon) - sin_target;
+                };
+                auto refine = [&](int e) {
+                    double a = epoch_JDs[e - 1];
+                    double b = epoch_JDs[e];
+                    double root = findRootBrent(above_target, a, b, above_target(a), above_target(b), 1.0 / 86400.0);
+                    return static_cast<float>((root - start_JD) * 24.0);
+                };
+
+                std::size_t cell = static_cast<std::size_t>(row) * width + column;
+                if (rise_bracket[column] != NONE) {
+                    raster.riseHours[cell] = refine(rise_bracket[column]);
+                }
+                if (set_bracket[column] != NONE) {
+                    raster.setHours[cell] = refine(set_bracket[column]);
+                }
+            }
+        }
+    });
+    return raster;
+}
+
+// Writes a raster as an 8-bit PGM image when the path ends in ".pgm" (values mapped
+// linearly from [min_value, max_value] to 1..255, NaN to 0), otherwise as raw row-major
+// little-endian float32.
+inline bool writeRaster(const std::string& path, const RasterGrid& grid, const std::vector<float>& values,
+                        double min_value, double max_value) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    const bool pgm = path.size() >= 4 && path.compare(path.size() - 4, 4, ".pgm") == 0;
+
+    if (pgm) {
+        out << "P5\n" << grid.width() << " " << grid.height() << "\n255\n";
+        std::vector<unsigned char> pixels(values.size());
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (std::isnan(values[i])) {
+                pixels[i] = 0;
+            } else {
+                double t = std::clamp((values[i] - min_value) / (max_value - min_value), 0.0, 1.0);
+                pixels[i] = static_cast<unsigned char>(1 + std::lround(t * 254.0));
+            }
+        }
+        out.write(reinterpret_cast<const char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+    } else {
+        for (float value : values) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            unsigned char bytes[4] = {static_cast<unsigned char>(bits), static_cast<unsigned char>(bits >> 8),
+                                      static_cast<unsigned char>(bits >> 16), static_cast<unsigned char>(bits >> 24)};
+            out.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+        }
+    }
+
+    if (!out) {
+        std::cerr << "Error: could not write raster " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+#endif
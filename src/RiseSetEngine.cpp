@@ -0,0 +1,120 @@
+#ifndef TSUKI_RISE_SET_ENGINE_CPP
+#define TSUKI_RISE_SET_ENGINE_CPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <HorizonScan.cpp>
+#include <LunarTrack.cpp>
+
+struct RiseSetResult {
+    HorizonClass horizonClass = HorizonClass::MayCross;
+    HorizonCrossings crossings;
+};
+
+// Moonrise/moonset for many observers over one window. Everything that does not depend on
+// the observer is done once in the constructor: the interpolated geocentric track, and for
+// each epoch on the DENSE_STEP_JD grid the sidereal time, RA, declination and parallax.
+// Each observer then costs only the topocentric transform at the grid epochs its scan
+// visits, plus the off-grid epochs Brent refines on. Observers whose latitude keeps the Moon
+// up or down for the whole window (classifyHorizon) are answered without scanning.
+class RiseSetEngine {
+public:
+    RiseSetEngine(double start_JD, double end_JD, HorizonScan horizon_scan = HorizonScan::Adaptive,
+                  double target_alt_deg = HORIZON_ALT_DEG)
+        : scan(horizon_scan), targetAltitude(target_alt_deg), track(start_JD, end_JD) {
+        std::size_t count = static_cast<std::size_t>(std::ceil((end_JD - start_JD) / DENSE_STEP_JD)) + 1;
+        epochs.reserve(count);
+        epochJDs.reserve(count);
+
+        double min_declination = PI;
+        double max_declination = -PI;
+        double min_distance = std::numeric_limits<double>::infinity();
+        for (std::size_t i = 0; i < count; ++i) {
+            double JD = std::min(start_JD + static_cast<double>(i) * DENSE_STEP_JD, end_JD);
+            EquatorialCoords moon = track.at(JD);
+            epochs.push_back(makeTopocentricEpoch(moon, JD));
+            epochJDs.push_back(JD);
+            min_declination = std::min(min_declination, moon.declination);
+            max_declination = std::max(max_declination, moon.declination);
+            min_distance = std::min(min_distance, moon.distance);
+        }
+
+        // Declination is sampled every 5 minutes, so the range is padded only for the curvature
+        // between samples.
+        constexpr double DECLINATION_PAD_DEG = 0.01;
+        constexpr double DISTANCE_PAD_KM = 100.0;
+        minDeclinationDeg = radiansToDegrees(min_declination) - DECLINATION_PAD_DEG;
+        maxDeclinationDeg = radiansToDegrees(max_declination) + DECLINATION_PAD_DEG;
+        maxParallaxDeg = radiansToDegrees(asin(EARTH_RADIUS_KM / (min_distance - DISTANCE_PAD_KM)));
+    }
+
+    RiseSetResult compute(const ObserverSite& observer) const {
+        RiseSetResult result;
+        result.horizonClass = classifyHorizon(observer.latitude, minDeclinationDeg, maxDeclinationDeg, maxParallaxDeg, targetAltitude);
+        if (result.horizonClass != HorizonClass::MayCross) {
+            return result;
+        }
+
+        const ObserverGeometry& geometry = observer.geometry;
+        HorizonCrossings& crossings = result.crossings;
+
+        auto grid_altitude_above_target = [&](std::size_t i) {
+            ++crossings.evaluations;
+            return getTopocentricAltitude(epochs[i], geometry) - targetAltitude;
+        };
+        auto altitude_above_target = [&](double JD) {
+            ++crossings.evaluations;
+            return getTopocentricAltitude(makeTopocentricEpoch(track.at(JD), JD), geometry) - targetAltitude;
+        };
+
+        const double TOLERANCE_JD = 1.0 / (24.0 * 60.0 * 60.0);
+        const std::size_t last = epochs.size() - 1;
+        std::size_t prev = 0;
+        double prev_diff = grid_altitude_above_target(prev);
+
+        while (prev < last) {
+            std::size_t step = 1;
+            if (scan == HorizonScan::Adaptive) {
+                double safe_days = (std::abs(prev_diff) - ADAPTIVE_MARGIN_DEG) / MAX_LUNAR_ALTITUDE_RATE_DEG_PER_DAY;
+                step = std::max<std::size_t>(1, static_cast<std::size_t>(safe_days / DENSE_STEP_JD));
+            }
+            std::size_t current = std::min(prev + step, last);
+            double current_diff = grid_altitude_above_target(current);
+
+            if (prev_diff < 0.0 && current_diff >= 0.0) {
+                crossings.rises.push_back(findRootBrent(altitude_above_target, epochJDs[prev], epochJDs[current], prev_diff, current_diff, TOLERANCE_JD));
+            } else if (prev_diff > 0.0 && current_diff <= 0.0) {
+                crossings.sets.push_back(findRootBrent(altitude_above_target, epochJDs[prev], epochJDs[current], prev_diff, current_diff, TOLERANCE_JD));
+            }
+
+            prev = current;
+            prev_diff = current_diff;
+        }
+        return result;
+    }
+
+    std::vector<RiseSetResult> compute(std::span<const ObserverSite> observers) const {
+        std::vector<RiseSetResult> results;
+        results.reserve(observers.size());
+        for (const ObserverSite& observer : observers) {
+            results.push_back(compute(observer));
+        }
+        return results;
+    }
+
+private:
+    HorizonScan scan;
+    double targetAltitude;
+    LunarTrack track;
+    std::vector<TopocentricEpoch> epochs;
+    std::vector<double> epochJDs;
+    double minDeclinationDeg;
+    double maxDeclinationDeg;
+    double maxParallaxDeg;
+};
+
+#endif
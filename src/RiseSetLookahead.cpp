@@ -0,0 +1,89 @@
+#ifndef TSUKI_RISE_SET_LOOKAHEAD_CPP
+#define TSUKI_RISE_SET_LOOKAHEAD_CPP
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
+#include <HorizonScan.cpp>
+#include <LunarTrack.cpp>
+
+// Classifies a period of at most one day from the Moon's position at its two ends: within a
+// day the declination strays less than 0.3 deg from the chord between them (0.27 deg worst
+// case over 2000-2020). Parallax is taken at the closer end, plus slack.
+inline HorizonClass classifyLunarDay(const EquatorialCoords& start, const EquatorialCoords& end, double latitude_deg,
+                                     double target_alt_deg = HORIZON_ALT_DEG) {
+    constexpr double DECLINATION_CURVATURE_PAD_DEG = 0.5;
+    constexpr double DISTANCE_PAD_KM = 500.0;
+
+    double dec_start = radiansToDegrees(start.declination);
+    double dec_end = radiansToDegrees(end.declination);
+    double max_parallax_deg = radiansToDegrees(asin(EARTH_RADIUS_KM / (std::min(start.distance, end.distance) - DISTANCE_PAD_KM)));
+
+    return classifyHorizon(latitude_deg,
+                           std::min(dec_start, dec_end) - DECLINATION_CURVATURE_PAD_DEG,
+                           std::max(dec_start, dec_end) + DECLINATION_CURVATURE_PAD_DEG,
+                           max_parallax_deg, target_alt_deg);
+}
+
+enum class SearchDirection {
+    Forward,
+    Backward
+};
+
+struct NearestCrossings {
+    std::optional<double> rise;
+    std::optional<double> set;
+};
+
+// The Moon's declination runs through its full range every tropical month (27.3 days), so any
+// latitude that sees it cross the horizon at all does so within this span.
+constexpr double RISE_SET_LOOKAHEAD_DAYS = 30.0;
+
+// The first moonrise and moonset after from_JD (Forward) or the last before it (Backward),
+// within max_days. Events already set in `known` are kept. The search walks one day at a time
+// and stops as soon as both are known. Days that classifyLunarDay proves circumpolar cost one
+// position evaluation and are not scanned, so a weeks-long polar day or night stays cheap.
+inline NearestCrossings findNearestCrossings(double longitude_deg, double latitude_deg, double from_JD, SearchDirection direction,
+                                             NearestCrossings known = {}, double max_days = RISE_SET_LOOKAHEAD_DAYS, HorizonScan horizon_scan = HorizonScan::Adaptive) {
+    if (known.rise && known.set) {
+        return known;
+    }
+    const double day_step = direction == SearchDirection::Forward ? 1.0 : -1.0;
+    const ObserverGeometry observer = makeObserverGeometry(longitude_deg, latitude_deg);
+
+    NearestCrossings nearest = known;
+    double near_JD = from_JD;
+    EquatorialCoords near_position = getApparentLunarEquatorial(near_JD);
+    for (int day = 0; day < static_cast<int>(std::ceil(max_days)); ++day) {
+        const double far_JD = near_JD + day_step;
+        const EquatorialCoords far_position = getApparentLunarEquatorial(far_JD);
+
+        if (classifyLunarDay(near_position, far_position, latitude_deg) == HorizonClass::MayCross) {
+            const double start_JD = std::min(near_JD, far_JD);
+            const double end_JD = std::max(near_JD, far_JD);
+            const LunarTrack track(start_JD, end_JD);
+            auto altitude = [&](double JD) {
+                return getTopocentricAltitude(makeTopocentricEpoch(track.at(JD), JD), observer);
+            };
+            HorizonCrossings crossings = findHorizonCrossings(altitude, start_JD, end_JD, HORIZON_ALT_DEG, horizon_scan);
+
+            auto take = [&](std::optional<double>& found, const std::vector<double>& events) {
+                if (!found && !events.empty()) {
+                    found = direction == SearchDirection::Forward ? events.front() : events.back();
+                }
+            };
+            take(nearest.rise, crossings.rises);
+            take(nearest.set, crossings.sets);
+            if (nearest.rise && nearest.set) {
+                break;
+            }
+        }
+
+        near_JD = far_JD;
+        near_position = far_position;
+    }
+    return nearest;
+}
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef TSUKI_ROOT_FINDER_CPP
+#define TSUKI_ROOT_FINDER_CPP
+
+#include <cmath>
+#include <utility>
+
+// Brent's method: inverse quadratic interpolation and secant steps, falling back to
+// bisection whenever they stop shrinking the bracket. `f_a` and `f_b` are the function
+// values already known at the bracket ends and must differ in sign. Smooth functions like
+// altitude-versus-time converge in 4-6 evaluations to `tolerance`.
+template <typename Function>
+double findRootBrent(Function&& f, double a, double b, double f_a, double f_b, double tolerance, int max_iterations = 50) {
+    if (f_a == 0.0) {
+        return a;
+    }
+    if (f_b == 0.0) {
+        return b;
+    }
+
+    double c = a;
+    double f_c = f_a;
+    double d = b - a;
+    double e = d;
+
+    for (int i = 0; i < max_iterations; ++i) {
+        if ((f_b > 0.0) == (f_c > 0.0)) {
+            c = a;
+            f_c = f_a;
+            d = b - a;
+            e = d;
+        }
+        if (std::abs(f_c) < std::abs(f_b)) {
+            a = b;
+            b = c;
+            c = a;
+            f_a = f_b;
+            f_b = f_c;
+            f_c = f_a;
+        }
+
+        const double tol = 2.0 * 1e-15 * std::abs(b) + 0.5 * tolerance;
+        const double m = 0.5 * (c - b);
+        if (std::abs(m) <= tol || f_b == 0.0) {
+            return b;
+        }
+
+        if (std::abs(e) >= tol && std::abs(f_a) > std::abs(f_b)) {
+            double p, q;
+            double s = f_b / f_a;
+            if (a == c) {
+                p = 2.0 * m * s;
+                q = 1.0 - s;
+            } else {
+                double r = f_b / f_c;
+                double t = f_a / f_c;
+                p = s * (2.0 * m * t * (t - r) - (b - a) * (r - 1.0));
+                q = (t - 1.0) * (r - 1.0) * (s - 1.0);
+            }
+            if (p > 0.0) {
+                q = -q;
+            } else {
+                p = -p;
+            }
+            if (2.0 * p < std::min(3.0 * m * q - std::abs(tol * q), std::abs(e * q))) {
+                e = d;
+                d = p / q;
+            } else {
+                d = m;
+                e = m;
+            }
+        } else {
+            d = m;
+            e = m;
+        }
+
+        a = b;
+        f_a = f_b;
+        b += std::abs(d) > tol ? d : (m > 0.0 ? tol : -tol);
+        f_b = f(b);
+    }
+    return b;
+}
+
+// Brent's method for the maximum of a function unimodal on [a, b], from a point x inside the
+// bracket whose value f_x is already known: parabolic interpolation through the three best
+// points, golden-section steps whenever the parabola misbehaves. `tolerance` is absolute,
+// so it can be far below sqrt(epsilon) * |x| for Julian days. Returns the abscissa and sets
+// f_max to the value there.
+template <typename Function>
+double findMaximumBrent(Function&& f, double a, double x, double b, double f_x, double tolerance, double& f_max, int max_iterations = 50) {
+    constexpr double GOLDEN_SECTION = 0.3819660112501051;
+
+    // Minimizes g = -f.
+    double g_x = -f_x;
+    double w = x;
+    double v = x;
+    double g_w = g_x;
+    double g_v = g_x;
+    double d = 0.0;
+    double e = 0.0;
+
+    for (int i = 0; i < max_iterations; ++i) {
+        const double m = 0.5 * (a + b);
+        const double tol = 1e-15 * std::abs(x) + 0.5 * tolerance;
+        if (std::abs(x - m) <= 2.0 * tol - 0.5 * (b - a)) {
+            break;
+        }
+
+        bool golden = true;
+        if (std::abs(e) > tol) {
+            double r = (x - w) * (g_x - g_v);
+            double q = (x - v) * (g_x - g_w);
+            double p = (x - v) * q - (x - w) * r;
+            q = 2.0 * (q - r);
+            if (q > 0.0) {
+                p = -p;
+            }
+            q = std::abs(q);
+            if (std::abs(p) < std::abs(0.5 * q * e) && p > q * (a - x) && p < q * (b - x)) {
+                e = d;
+                d = p / q;
+                double u = x + d;
+                if (u - a < 2.0 * tol || b - u < 2.0 * tol) {
+                    d = m > x ? tol : -tol;
+                }
+                golden = false;
+            }
+        }
+        if (golden) {
+            e = x >= m ? a - x : b - x;
+            d = GOLDEN_SECTION * e;
+        }
+
+        const double u = std::abs(d) >= tol ? x + d : x + (d > 0.0 ? tol : -tol);
+        const double g_u = -f(u);
+        if (g_u <= g_x) {
+            if (u >= x) {
+                a = x;
+            } else {
+                b = x;
+            }
+            v = w;
+            g_v = g_w;
+            w = x;
+            g_w = g_x;
+            x = u;
+            g_x = g_u;
+        } else {
+            if (u < x) {
+                a = u;
+            } else {
+                b = u;
+            }
+            if (g_u <= g_w || w == x) {
+                v = w;
+                g_v = g_w;
+                w = u;
+                g_w = g_u;
+            } else if (g_u <= g_v || v == x || v == w) {
+                v = u;
+                g_v = g_u;
+            }
+        }
+    }
+    f_max = -g_x;
+    return x;
+}
+
+#endif
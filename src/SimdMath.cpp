@@ -0,0 +1,272 @@
+#ifndef TSUKI_SIMD_MATH_CPP
+#define TSUKI_SIMD_MATH_CPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TSUKI_X86_SIMD 1
+#endif
+
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+inline const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SSE2:   return "sse2";
+        case SimdLevel::AVX2:   return "avx2";
+        case SimdLevel::AVX512: return "avx512";
+        default:                return "scalar";
+    }
+}
+
+inline SimdLevel detectSimdLevel() {
+#ifdef TSUKI_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SimdLevel::SSE2;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+inline std::atomic<SimdLevel>& simdLevelSetting() {
+    static std::atomic<SimdLevel> level{detectSimdLevel()};
+    return level;
+}
+
+// The level used by the batch kernels.
+inline SimdLevel activeSimdLevel() {
+    return simdLevelSetting().load(std::memory_order_relaxed);
+}
+
+// Requests above what the CPU supports are clamped.
+inline void setSimdLevel(SimdLevel level) {
+    SimdLevel supported = detectSimdLevel();
+    simdLevelSetting().store(level > supported ? supported : level, std::memory_order_relaxed);
+}
+
+// Vector-typed helpers are force-inlined into the target("...") entry points, so no vector
+// crosses a real call boundary. Many of them still return vectors by value, which GCC
+// reports under -Wpsabi; the CMake targets build with -Wno-psabi for that reason.
+#if defined(__GNUC__)
+#define SIMD_INLINE __attribute__((always_inline)) inline
+#else
+#define SIMD_INLINE inline
+#endif
+
+template <typename V>
+struct SimdTraits {
+    static constexpr int lanes = 0;
+};
+
+template <typename V>
+concept SimdVector = SimdTraits<V>::lanes > 0;
+
+#ifdef TSUKI_X86_SIMD
+
+typedef double vdouble4 __attribute__((vector_size(32)));
+typedef double vdouble8 __attribute__((vector_size(64)));
+typedef long long vint64x4 __attribute__((vector_size(32)));
+typedef long long vint64x8 __attribute__((vector_size(64)));
+
+template <>
+struct SimdTraits<vdouble4> {
+    using mask = vint64x4;
+    static constexpr int lanes = 4;
+};
+
+template <>
+struct SimdTraits<vdouble8> {
+    using mask = vint64x8;
+    static constexpr int lanes = 8;
+};
+
+namespace {
+
+template <SimdVector V>
+SIMD_INLINE V simdBroadcast(double x) {
+    V v = {};
+    return v + x;
+}
+
+template <SimdVector V>
+SIMD_INLINE V simdLoad(const double* p) {
+    V v;
+    __builtin_memcpy(&v, p, sizeof(V));
+    return v;
+}
+
+template <SimdVector V>
+SIMD_INLINE void simdStore(double* p, const V& v) {
+    __builtin_memcpy(p, &v, sizeof(V));
+}
+
+template <SimdVector V>
+SIMD_INLINE V simdSelect(const typename SimdTraits<V>::mask& m, const V& a, const V& b) {
+    return m ? a : b;
+}
+
+// Round-to-nearest through the 1.5 * 2^52 trick; valid for |x| < 2^51.
+template <SimdVector V>
+SIMD_INLINE V simdRound(const V& x) {
+    const V magic = simdBroadcast<V>(6755399441055744.0);
+    return (x + magic) - magic;
+}
+
+template <SimdVector V>
+SIMD_INLINE V simdFloor(const V& x) {
+    V t = simdRound(x);
+    return simdSelect<V>(t > x, t - 1.0, t);
+}
+
+template <SimdVector V>
+SIMD_INLINE V normalizeDegrees(const V& angle) {
+    return angle - 360.0 * simdFloor(angle * (1.0 / 360.0));
+}
+
+// fdlibm-style sin/cos: Cody-Waite reduction by pi/2 and the __kernel_sin/__kernel_cos
+// polynomials. Within 2 ulp of libm for the argument range used by the series (|x| < 1e5).
+template <SimdVector V>
+SIMD_INLINE void simdSinCos(const V& x, V& s, V& c) {
+    using M = typename SimdTraits<V>::mask;
+
+    constexpr double PIO2_1 = 1.57079632673412561417e+00;
+    constexpr double PIO2_2 = 6.07710050630396597660e-11;
+    constexpr double PIO2_3 = 2.02226624871116645580e-21;
+    constexpr double PIO2_3T = 8.47842766036889956997e-32;
+
+    constexpr double S1 = -1.66666666666666324348e-01;
+    constexpr double S2 = 8.33333333332248946124e-03;
+    constexpr double S3 = -1.98412698298579493134e-04;
+    constexpr double S4 = 2.75573137070700676789e-06;
+    constexpr double S5 = -2.50507602534068634195e-08;
+    constexpr double S6 = 1.58969099521155010221e-10;
+
+    constexpr double C1 = 4.16666666666666019037e-02;
+    constexpr double C2 = -1.38888888888741095749e-03;
+    constexpr double C3 = 2.48015872894767294178e-05;
+    constexpr double C4 = -2.75573143513906633035e-07;
+    constexpr double C5 = 2.08757232129817482790e-09;
+    constexpr double C6 = -1.13596475577881948265e-11;
+
+    const V magic = simdBroadcast<V>(6755399441055744.0);
+    V shifted = x * 6.36619772367581382433e-01 + magic;
+    M quadrant = (M)shifted;
+    V q = shifted - magic;
+
+    V r = x - q * PIO2_1;
+    r = r - q * PIO2_2;
+    r = r - q * PIO2_3;
+    r = r - q * PIO2_3T;
+
+    V z = r * r;
+    V sin_r = r + r * z * (S1 + z * (S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)))));
+
+    V hz = 0.5 * z;
+    V w = 1.0 - hz;
+    V cos_poly = z * z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6)))));
+    V cos_r = w + (((1.0 - w) - hz) + cos_poly);
+
+    M swap = (quadrant & 1) != 0;
+    V s0 = simdSelect<V>(swap, cos_r, sin_r);
+    V c0 = simdSelect<V>(swap, sin_r, cos_r);
+
+    M sin_negative = (quadrant & 2) != 0;
+    M cos_negative = ((quadrant + 1) & 2) != 0;
+    s = simdSelect<V>(sin_negative, -s0, s0);
+    c = simdSelect<V>(cos_negative, -c0, c0);
+}
+
+template <SimdVector V>
+SIMD_INLINE V sin(const V& x) {
+    V s, c;
+    simdSinCos(x, s, c);
+    return s;
+}
+
+template <SimdVector V>
+SIMD_INLINE V cos(const V& x) {
+    V s, c;
+    simdSinCos(x, s, c);
+    return c;
+}
+
+}
+
+#endif
+
+template <typename V>
+constexpr std::size_t simdLanes() {
+    if constexpr (std::is_same_v<V, double>) {
+        return 1;
+    } else {
+        return SimdTraits<V>::lanes;
+    }
+}
+
+// Runs Kernel::run over `in`, Lanes epochs at a time, writing one value per output span.
+// A short tail is padded with the last epoch so every kernel call is full width.
+template <typename V, std::size_t Outputs, typename Kernel>
+SIMD_INLINE void simdBatch(std::span<const double> in, const std::array<std::span<double>, Outputs>& out) {
+    for (const auto& o : out) {
+        if (o.size() < in.size()) {
+            throw std::invalid_argument("simdBatch: output spans are smaller than the input span");
+        }
+    }
+
+    const std::size_t n = in.size();
+    constexpr std::size_t lanes = simdLanes<V>();
+
+    if constexpr (lanes == 1) {
+        for (std::size_t i = 0; i < n; ++i) {
+            double results[Outputs];
+            Kernel::run(in[i], results);
+            for (std::size_t k = 0; k < Outputs; ++k) {
+                out[k][i] = results[k];
+            }
+        }
+    } else {
+        std::size_t i = 0;
+        for (; i + lanes <= n; i += lanes) {
+            V results[Outputs];
+            Kernel::run(simdLoad<V>(&in[i]), results);
+            for (std::size_t k = 0; k < Outputs; ++k) {
+                simdStore(&out[k][i], results[k]);
+            }
+        }
+
+        if (i < n) {
+            double padded[lanes];
+            for (std::size_t j = 0; j < lanes; ++j) {
+                padded[j] = in[std::min(i + j, n - 1)];
+            }
+
+            V results[Outputs];
+            Kernel::run(simdLoad<V>(padded), results);
+            for (std::size_t k = 0; k < Outputs; ++k) {
+                double lane_values[lanes];
+                simdStore(lane_values, results[k]);
+                std::copy(lane_values, lane_values + (n - i), &out[k][i]);
+            }
+        }
+    }
+}
+
+#endif
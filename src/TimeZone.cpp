@@ -0,0 +1,586 @@
+#ifndef TSUKI_TIME_ZONE_CPP
+#define TSUKI_TIME_ZONE_CPP
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <JulianDay.cpp>
+
+#if defined(__cpp_lib_chrono) && __cpp_lib_chrono >= 201907L
+#define TSUKI_HAS_TZDB 1
+#else
+#include <fstream>
+#endif
+
+constexpr std::int64_t SECONDS_PER_DAY = 86400;
+
+// Days since 1970-01-01 of a proleptic Gregorian date, and back (H. Hinnant's algorithms).
+// daysFromCivil is linear in the day, so an out-of-range day normalizes through civilFromDays.
+constexpr std::int64_t daysFromCivil(std::int64_t year, int month, int day) {
+    year -= month <= 2;
+    const std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const std::int64_t year_of_era = year - era * 400;
+    const std::int64_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const std::int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+constexpr void civilFromDays(std::int64_t days, int& year, int& month, int& day) {
+    days += 719468;
+    const std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const std::int64_t day_of_era = days - era * 146097;
+    const std::int64_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    const std::int64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const std::int64_t month_index = (5 * day_of_year + 2) / 153;
+    day = static_cast<int>(day_of_year - (153 * month_index + 2) / 5 + 1);
+    month = static_cast<int>(month_index < 10 ? month_index + 3 : month_index - 9);
+    year = static_cast<int>(year_of_era + era * 400 + (month <= 2));
+}
+
+constexpr std::int64_t floorDiv(std::int64_t a, std::int64_t b) {
+    return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+// 0 = Sunday, as in std::tm (1970-01-01 was a Thursday).
+constexpr int weekdayFromDays(std::int64_t days) {
+    return static_cast<int>(days + 4 - floorDiv(days + 4, 7) * 7);
+}
+
+// Breaks seconds since the epoch down into a std::tm without gmtime_r, which takes the
+// C library's time zone lock.
+inline std::tm secondsToTm(std::int64_t seconds, bool is_dst = false) {
+    const std::int64_t days = floorDiv(seconds, SECONDS_PER_DAY);
+    const std::int64_t second_of_day = seconds - days * SECONDS_PER_DAY;
+    int year, month, day;
+    civilFromDays(days, year, month, day);
+
+    std::tm result{};
+    result.tm_year = year - 1900;
+    result.tm_mon = month - 1;
+    result.tm_mday = day;
+    result.tm_hour = static_cast<int>(second_of_day / 3600);
+    result.tm_min = static_cast<int>(second_of_day / 60 % 60);
+    result.tm_sec = static_cast<int>(second_of_day % 60);
+    result.tm_wday = weekdayFromDays(days);
+    result.tm_yday = static_cast<int>(days - daysFromCivil(year, 1, 1));
+    result.tm_isdst = is_dst ? 1 : 0;
+    return result;
+}
+
+inline std::int64_t julianDayToSeconds(double JD) {
+    return fromJulianDay<std::chrono::seconds>(JD).time_since_epoch().count();
+}
+
+inline double secondsToJulianDay(std::int64_t seconds) {
+    return toJulianDay(std::chrono::sys_seconds{std::chrono::seconds{seconds}});
+}
+
+// A time zone's UTC offsets as a table of periods, loaded once from the tz database
+// (std::chrono::tzdb where the standard library has it, otherwise the system's TZif files).
+// Windows without tzdb, and any system whose database cannot be read, get the table from
+// the C library's own localtime instead.
+// After loading it is immutable: conversions are a binary search over the period starts,
+// with no locks and no file access, so any number of threads can share one TimeZone.
+// The table runs to TABLE_END_YEAR; the last period's offset holds after that.
+class TimeZone {
+public:
+    static constexpr int TABLE_START_YEAR = 1800;
+    static constexpr int TABLE_END_YEAR = 2400;
+
+    // A named zone such as "Europe/Oslo". Returns nullptr (after reporting why) if the
+    // database has no such zone.
+    static std::unique_ptr<TimeZone> locate(const std::string& name) {
+        std::unique_ptr<TimeZone> zone = load(name);
+        if (!zone) {
+            std::cerr << "Error: unknown time zone " << name << std::endl;
+        }
+        return zone;
+    }
+
+    // The process time zone (the TZ environment variable, else the system setting), loaded on
+    // first use. Falls back to the C library's conversions, and to UTC only if those fail too.
+    static const TimeZone& local() {
+        static const std::unique_ptr<TimeZone> zone = []() {
+            std::unique_ptr<TimeZone> loaded = loadLocal();
+            if (!loaded) {
+                loaded = fromCLibrary();
+            }
+            if (!loaded) {
+                std::cerr << "Error: could not load the local time zone; using UTC." << std::endl;
+                loaded.reset(new TimeZone());
+                loaded->addPeriod(std::numeric_limits<std::int64_t>::min(), 0, false);
+            }
+            return loaded;
+        }();
+        return *zone;
+    }
+
+    // Offset of local time from UTC, in seconds, at a UTC instant.
+    int utcOffset(std::int64_t utc_seconds) const {
+        return periods[periodAt(utc_seconds)].offset;
+    }
+
+    // The UTC instant of a local wall-clock time. A time repeated when clocks go back maps to
+    // its first occurrence; one skipped when they go forward maps to the instant of the jump.
+    std::int64_t localToUtc(std::int64_t local_seconds) const {
+        const std::size_t guess = periodAt(local_seconds - utcOffset(local_seconds));
+        const std::size_t first = guess > 0 ? guess - 1 : 0;
+        const std::size_t last = std::min(guess + 1, periods.size() - 1);
+
+        for (std::size_t i = first; i <= last; ++i) {
+            const std::int64_t utc = local_seconds - periods[i].offset;
+            if (utc >= begins[i] && (i + 1 == periods.size() || utc < begins[i + 1])) {
+                return utc;
+            }
+        }
+        for (std::size_t i = first; i < last; ++i) {
+            if (local_seconds - periods[i].offset >= begins[i + 1] && local_seconds - periods[i + 1].offset < begins[i + 1]) {
+                return begins[i + 1];
+            }
+        }
+        return local_seconds - periods[guess].offset;
+    }
+
+    std::tm localTm(double JD_utc) const {
+        const std::int64_t utc = julianDayToSeconds(JD_utc);
+        const Period& period = periods[periodAt(utc)];
+        return secondsToTm(utc + period.offset, period.isDst);
+    }
+
+    // Local midnight starting a calendar date, as a UTC Julian day. An out-of-range day is
+    // normalized, and the normalized date is written back.
+    double localMidnightJD(int& year, int& month, int& day) const {
+        const std::int64_t days = daysFromCivil(year, month, day);
+        civilFromDays(days, year, month, day);
+        return secondsToJulianDay(localToUtc(days * SECONDS_PER_DAY));
+    }
+
+    // Local midnight starting the local day that contains JD_utc.
+    double localMidnightJD(double JD_utc) const {
+        const std::int64_t utc = julianDayToSeconds(JD_utc);
+        const std::int64_t local_day = floorDiv(utc + utcOffset(utc), SECONDS_PER_DAY);
+        return secondsToJulianDay(localToUtc(local_day * SECONDS_PER_DAY));
+    }
+
+private:
+    struct Period {
+        std::int32_t offset;
+        bool isDst;
+    };
+
+    // begins[i] is the UTC second periods[i] starts; begins[0] is the minimum int64.
+    std::vector<std::int64_t> begins;
+    std::vector<Period> periods;
+
+    TimeZone() = default;
+
+    std::size_t periodAt(std::int64_t utc_seconds) const {
+        return static_cast<std::size_t>(std::upper_bound(begins.begin(), begins.end(), utc_seconds) - begins.begin()) - 1;
+    }
+
+    void addPeriod(std::int64_t begin, std::int32_t offset, bool is_dst) {
+        if (!periods.empty() && (begin <= begins.back() || (periods.back().offset == offset && periods.back().isDst == is_dst))) {
+            return;
+        }
+        begins.push_back(begin);
+        periods.push_back(Period{offset, is_dst});
+    }
+
+    // The offset localtime gives at a UTC second, or false if it cannot convert it.
+    static bool cLibraryPeriod(std::int64_t utc_seconds, Period& period) {
+        const std::time_t time = static_cast<std::time_t>(utc_seconds);
+        std::tm local_tm{};
+#ifdef _WIN32
+        if (localtime_s(&local_tm, &time) != 0) {
+            return false;
+        }
+#else
+        if (localtime_r(&time, &local_tm) == nullptr) {
+            return false;
+        }
+#endif
+        const std::int64_t local_seconds = daysFromCivil(local_tm.tm_year + 1900, local_tm.tm_mon + 1, local_tm.tm_mday) * SECONDS_PER_DAY +
+                                           local_tm.tm_hour * 3600 + local_tm.tm_min * 60 + local_tm.tm_sec;
+        period = Period{static_cast<std::int32_t>(local_seconds - utc_seconds), local_tm.tm_isdst > 0};
+        return true;
+    }
+
+    // The table probed from localtime: weekly samples from 1970 (where Windows' localtime_s
+    // starts) to TABLE_END_YEAR, each change bisected to the second. Offsets before 1970 are
+    // taken as 1970's. Slower than reading the database, but it agrees with the C library.
+    static std::unique_ptr<TimeZone> fromCLibrary() {
+        constexpr std::int64_t PROBE_STEP = 7 * SECONDS_PER_DAY;
+        const std::int64_t table_end = daysFromCivil(TABLE_END_YEAR, 1, 1) * SECONDS_PER_DAY;
+#ifdef _WIN32
+        _tzset();
+#else
+        tzset();
+#endif
+        auto same = [](const Period& a, const Period& b) {
+            return a.offset == b.offset && a.isDst == b.isDst;
+        };
+
+        Period previous;
+        if (!cLibraryPeriod(0, previous)) {
+            return nullptr;
+        }
+        std::unique_ptr<TimeZone> zone(new TimeZone());
+        zone->addPeriod(std::numeric_limits<std::int64_t>::min(), previous.offset, previous.isDst);
+        for (std::int64_t probe = PROBE_STEP; probe < table_end; probe += PROBE_STEP) {
+            Period current;
+            if (!cLibraryPeriod(probe, current)) {
+                break;
+            }
+            if (same(current, previous)) {
+                continue;
+            }
+            std::int64_t before = probe - PROBE_STEP;
+            std::int64_t after = probe;
+            while (after - before > 1) {
+                const std::int64_t middle = before + (after - before) / 2;
+                Period period;
+                if (cLibraryPeriod(middle, period) && same(period, previous)) {
+                    before = middle;
+                } else {
+                    after = middle;
+                }
+            }
+            zone->addPeriod(after, current.offset, current.isDst);
+            previous = current;
+        }
+        return zone;
+    }
+
+#ifdef TSUKI_HAS_TZDB
+    static std::unique_ptr<TimeZone> fromTzdb(const std::chrono::time_zone* tz) {
+        using namespace std::chrono;
+        const sys_seconds table_start{sys_days{year{TABLE_START_YEAR} / January / 1}};
+        const sys_seconds table_end{sys_days{year{TABLE_END_YEAR} / January / 1}};
+
+        std::unique_ptr<TimeZone> zone(new TimeZone());
+        sys_info info = tz->get_info(table_start);
+        zone->addPeriod(std::numeric_limits<std::int64_t>::min(), static_cast<std::int32_t>(info.offset.count()), info.save != minutes{0});
+        while (info.end < table_end) {
+            info = tz->get_info(info.end);
+            zone->addPeriod(info.begin.time_since_epoch().count(), static_cast<std::int32_t>(info.offset.count()), info.save != minutes{0});
+        }
+        return zone;
+    }
+
+    static std::unique_ptr<TimeZone> load(const std::string& name) {
+        try {
+            return fromTzdb(std::chrono::locate_zone(name));
+        } catch (const std::runtime_error&) {
+            return nullptr;
+        }
+    }
+
+    static std::unique_ptr<TimeZone> loadLocal() {
+        try {
+            return fromTzdb(std::chrono::current_zone());
+        } catch (const std::runtime_error&) {
+            return nullptr;
+        }
+    }
+#else
+    // Without std::chrono::tzdb the zone comes from the compiled TZif files (RFC 8536) that
+    // the C library itself reads: the transition table, then the POSIX TZ rule in the footer
+    // expanded year by year to TABLE_END_YEAR.
+
+    static std::string zoneInfoDirectory() {
+        const char* dir = std::getenv("TZDIR");
+        return dir != nullptr && *dir != '\0' ? dir : "/usr/share/zoneinfo";
+    }
+
+    static std::unique_ptr<TimeZone> load(const std::string& name) {
+        if (name.empty() || name.find("..") != std::string::npos) {
+            return nullptr;
+        }
+        return fromTzifFile(name.front() == '/' ? name : zoneInfoDirectory() + "/" + name);
+    }
+
+    // As the C library interprets TZ: unset means /etc/localtime, empty means UTC, otherwise a
+    // zone name or path (optionally after a ':'), or failing that a POSIX TZ string.
+    static std::unique_ptr<TimeZone> loadLocal() {
+        const char* tz = std::getenv("TZ");
+        if (tz == nullptr) {
+#ifdef _WIN32
+            // No zoneinfo files: the system setting is only reachable through the C library.
+            return fromCLibrary();
+#else
+            return fromTzifFile("/etc/localtime");
+#endif
+        }
+        std::string name = *tz == ':' ? tz + 1 : tz;
+        if (name.empty()) {
+            name = "UTC0";
+        }
+        if (std::unique_ptr<TimeZone> zone = load(name)) {
+            return zone;
+        }
+        std::unique_ptr<TimeZone> zone(new TimeZone());
+        if (!zone->applyPosixRule(name, std::numeric_limits<std::int64_t>::min())) {
+            return nullptr;
+        }
+        return zone;
+    }
+
+    static std::unique_ptr<TimeZone> fromTzifFile(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            return nullptr;
+        }
+        const std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        auto read = [&](std::size_t offset, int bytes) {
+            std::uint64_t value = 0;
+            for (int i = 0; i < bytes; ++i) {
+                value = value << 8 | static_cast<unsigned char>(data[offset + static_cast<std::size_t>(i)]);
+            }
+            return value;
+        };
+
+        constexpr std::size_t HEADER_BYTES = 44;
+        if (data.size() < HEADER_BYTES || data.compare(0, 4, "TZif") != 0) {
+            return nullptr;
+        }
+        // Version 2 and later repeat the data with 64-bit times after the 32-bit block.
+        std::size_t header = 0;
+        int time_bytes = 4;
+        for (;;) {
+            const std::uint64_t utc_count = read(header + 20, 4);
+            const std::uint64_t std_count = read(header + 24, 4);
+            const std::uint64_t leap_count = read(header + 28, 4);
+            const std::uint64_t time_count = read(header + 32, 4);
+            const std::uint64_t type_count = read(header + 36, 4);
+            const std::uint64_t char_count = read(header + 40, 4);
+            const std::size_t block = time_count * (time_bytes + 1) + type_count * 6 + char_count +
+                                      leap_count * (time_bytes + 4) + std_count + utc_count;
+            if (data.size() < header + HEADER_BYTES + block || type_count == 0) {
+                return nullptr;
+            }
+            if (time_bytes == 4 && data[4] >= '2') {
+                header += HEADER_BYTES + block;
+                time_bytes = 8;
+                if (data.size() < header + HEADER_BYTES || data.compare(header, 4, "TZif") != 0) {
+                    return nullptr;
+                }
+                continue;
+            }
+
+            const std::size_t times = header + HEADER_BYTES;
+            const std::size_t indices = times + time_count * time_bytes;
+            const std::size_t types = indices + time_count;
+            auto period = [&](std::size_t type) {
+                const std::size_t entry = types + type * 6;
+                return Period{static_cast<std::int32_t>(static_cast<std::uint32_t>(read(entry, 4))), data[entry + 4] != 0};
+            };
+
+            std::unique_ptr<TimeZone> zone(new TimeZone());
+            const Period initial = period(0);
+            zone->addPeriod(std::numeric_limits<std::int64_t>::min(), initial.offset, initial.isDst);
+            for (std::size_t i = 0; i < time_count; ++i) {
+                std::uint64_t raw = read(times + i * time_bytes, time_bytes);
+                const std::int64_t begin = time_bytes == 8 ? static_cast<std::int64_t>(raw) : static_cast<std::int32_t>(static_cast<std::uint32_t>(raw));
+                const std::size_t type = static_cast<unsigned char>(data[indices + i]);
+                if (type >= type_count) {
+                    return nullptr;
+                }
+                const Period next = period(type);
+                zone->addPeriod(begin, next.offset, next.isDst);
+            }
+
+            // The footer is "\n<POSIX TZ string>\n" and governs times after the last transition.
+            const std::size_t footer = header + HEADER_BYTES + block;
+            if (time_bytes == 8 && footer < data.size() && data[footer] == '\n') {
+                const std::size_t footer_end = data.find('\n', footer + 1);
+                if (footer_end != std::string::npos && footer_end > footer + 1) {
+                    const std::int64_t after = time_count > 0 ? zone->begins.back() : std::numeric_limits<std::int64_t>::min();
+                    zone->applyPosixRule(data.substr(footer + 1, footer_end - footer - 1), after);
+                }
+            }
+            return zone;
+        }
+    }
+
+    // A POSIX TZ string, e.g. "CET-1CEST,M3.5.0,M10.5.0/3", applied from `after` onward. Offsets
+    // in it are west of Greenwich, so they are negated.
+    bool applyPosixRule(const std::string& rule, std::int64_t after) {
+        std::size_t pos = 0;
+
+        auto parse_name = [&]() {
+            if (pos < rule.size() && rule[pos] == '<') {
+                const std::size_t close = rule.find('>', pos);
+                if (close == std::string::npos) {
+                    return false;
+                }
+                pos = close + 1;
+                return true;
+            }
+            const std::size_t start = pos;
+            while (pos < rule.size() && std::isalpha(static_cast<unsigned char>(rule[pos]))) {
+                ++pos;
+            }
+            return pos - start >= 3;
+        };
+        // [+-]hh[:mm[:ss]], in seconds.
+        auto parse_time = [&](std::int64_t& seconds) {
+            int sign = 1;
+            if (pos < rule.size() && (rule[pos] == '+' || rule[pos] == '-')) {
+                sign = rule[pos] == '-' ? -1 : 1;
+                ++pos;
+            }
+            seconds = 0;
+            for (int field = 0; field < 3; ++field) {
+                if (field > 0) {
+                    if (pos >= rule.size() || rule[pos] != ':') {
+                        break;
+                    }
+                    ++pos;
+                }
+                if (pos >= rule.size() || !std::isdigit(static_cast<unsigned char>(rule[pos]))) {
+                    return false;
+                }
+                std::int64_t value = 0;
+                while (pos < rule.size() && std::isdigit(static_cast<unsigned char>(rule[pos]))) {
+                    value = value * 10 + (rule[pos++] - '0');
+                }
+                seconds += value * (field == 0 ? 3600 : field == 1 ? 60 : 1);
+            }
+            seconds *= sign;
+            return true;
+        };
+
+        struct Transition {
+            char kind = 'M'; // 'J' (1-365, no leap day), 'D' (0-365) or 'M' (month.week.weekday)
+            int month = 0;
+            int week = 0;
+            int day = 0;
+            std::int64_t time = 2 * 3600;
+        };
+        auto parse_number = [&](int& value) {
+            if (pos >= rule.size() || !std::isdigit(static_cast<unsigned char>(rule[pos]))) {
+                return false;
+            }
+            value = 0;
+            while (pos < rule.size() && std::isdigit(static_cast<unsigned char>(rule[pos]))) {
+                value = value * 10 + (rule[pos++] - '0');
+            }
+            return true;
+        };
+        auto parse_transition = [&](Transition& transition) {
+            if (pos >= rule.size() || rule[pos] != ',') {
+                return false;
+            }
+            ++pos;
+            if (pos < rule.size() && rule[pos] == 'M') {
+                ++pos;
+                if (!parse_number(transition.month) || pos >= rule.size() || rule[pos++] != '.' ||
+                    !parse_number(transition.week) || pos >= rule.size() || rule[pos++] != '.' || !parse_number(transition.day)) {
+                    return false;
+                }
+            } else {
+                transition.kind = 'D';
+                if (pos < rule.size() && rule[pos] == 'J') {
+                    transition.kind = 'J';
+                    ++pos;
+                }
+                if (!parse_number(transition.day)) {
+                    return false;
+                }
+            }
+            if (pos < rule.size() && rule[pos] == '/') {
+                ++pos;
+                return parse_time(transition.time);
+            }
+            return true;
+        };
+
+        std::int64_t std_west;
+        if (!parse_name() || !parse_time(std_west)) {
+            return false;
+        }
+        const std::int32_t std_offset = static_cast<std::int32_t>(-std_west);
+        if (pos == rule.size()) {
+            addPeriod(after, std_offset, false);
+            return true;
+        }
+
+        if (!parse_name()) {
+            return false;
+        }
+        std::int32_t dst_offset = std_offset + 3600;
+        if (pos < rule.size() && rule[pos] != ',') {
+            std::int64_t dst_west;
+            if (!parse_time(dst_west)) {
+                return false;
+            }
+            dst_offset = static_cast<std::int32_t>(-dst_west);
+        }
+        Transition start, end;
+        if (pos == rule.size()) {
+            // No rule given: the US rule, as the C library assumes.
+            start = Transition{'M', 3, 2, 0, 2 * 3600};
+            end = Transition{'M', 11, 1, 0, 2 * 3600};
+        } else if (!parse_transition(start) || !parse_transition(end) || pos != rule.size()) {
+            return false;
+        }
+
+        // Local midnight, in days since the epoch, of a transition's date in a given year.
+        auto transition_day = [](const Transition& transition, int year) -> std::int64_t {
+            const std::int64_t jan1 = daysFromCivil(year, 1, 1);
+            if (transition.kind == 'D') {
+                return jan1 + transition.day;
+            }
+            if (transition.kind == 'J') {
+                const bool leap = daysFromCivil(year, 3, 1) - daysFromCivil(year, 2, 1) == 29;
+                return jan1 + transition.day - 1 + (leap && transition.day >= 60);
+            }
+            const std::int64_t first = daysFromCivil(year, transition.month, 1);
+            std::int64_t day = first + (transition.day - weekdayFromDays(first) + 7) % 7 + 7 * (transition.week - 1);
+            const std::int64_t next_month = transition.month == 12 ? daysFromCivil(year + 1, 1, 1) : daysFromCivil(year, transition.month + 1, 1);
+            while (day >= next_month) {
+                day -= 7;
+            }
+            return day;
+        };
+
+        int first_year = TABLE_START_YEAR;
+        if (after != std::numeric_limits<std::int64_t>::min()) {
+            int month, day;
+            civilFromDays(floorDiv(after, SECONDS_PER_DAY), first_year, month, day);
+        }
+        std::vector<std::pair<std::int64_t, bool>> transitions;
+        for (int year = first_year; year <= TABLE_END_YEAR; ++year) {
+            // The start time is in standard time and the end time in daylight time.
+            transitions.emplace_back(transition_day(start, year) * SECONDS_PER_DAY + start.time - std_offset, true);
+            transitions.emplace_back(transition_day(end, year) * SECONDS_PER_DAY + end.time - dst_offset, false);
+        }
+        std::sort(transitions.begin(), transitions.end());
+
+        if (periods.empty()) {
+            // Before the first generated transition the zone is on the other side of it.
+            addPeriod(after, transitions.front().second ? std_offset : dst_offset, !transitions.front().second);
+        }
+        for (const auto& [begin, is_dst] : transitions) {
+            if (begin > after) {
+                addPeriod(begin, is_dst ? dst_offset : std_offset, is_dst);
+            }
+        }
+        return true;
+    }
+#endif
+};
+
+#endif
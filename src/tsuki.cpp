@@ -5,7 +5,8 @@
 #include <optional>
 #include <vector>
 #include <fstream>
-#include <map>
+#include <array>
+#include <sstream>
 
 #include "SFML/Graphics/RectangleShape.hpp"
 #include "SFML/System/String.hpp"
@@ -225,15 +226,32 @@ void updateSearchResults(const std::string& query, const std::vector<City>& allC
         }
     }
 }
-void updateMoonDisplay(MoonInfo& moonInfo, sf::Texture& moonTexture, sf::Sprite& moonSprite, sf::Text& infoText, const std::map<std::string, std::string>& phaseToFilename) {
-    auto it = phaseToFilename.find(moonInfo.phase);
-    std::string moonImageFile;
-    if (it != phaseToFilename.end()) {
-        moonImageFile = it->second;
-    } else {
-        std::cerr << "Warning: Could not find image for phase: " << moonInfo.phase << ". Defaulting to new moon." << std::endl;
-        moonImageFile = "assets/new_moon.png";
-    }
+// Moon textures, indexed by LunarPhase.
+const std::array<const char*, LUNAR_PHASE_COUNT> PHASE_TEXTURES = {
+    "assets/new_moon.png",
+    "assets/waxing_crescent.png",
+    "assets/first_quarter.png",
+    "assets/waxing_gibbous.png",
+    "assets/full_moon.png",
+    "assets/waning_gibbous.png",
+    "assets/last_quarter.png",
+    "assets/waning_crescent.png"
+};
+
+std::string moonInfoText(const MoonInfoResult& moon) {
+    char buffer[32];
+    auto text = [&](std::to_chars_result formatted) {
+        return std::string(buffer, formatted.ptr);
+    };
+    std::string info = "Illumination: " + text(formatIllumination(buffer, std::end(buffer), moon.illuminatedFraction)) + "%\n";
+    info += "Phase: " + std::string(lunarPhaseName(moon.phase)) + "\n";
+    info += "Moonrise: " + text(formatMoonrise(buffer, std::end(buffer), moon)) + "\n";
+    info += "Moonset: " + text(formatMoonset(buffer, std::end(buffer), moon));
+    return info;
+}
+
+void updateMoonDisplay(const MoonInfoResult& moon, sf::Texture& moonTexture, sf::Sprite& moonSprite, sf::Text& infoText) {
+    std::string moonImageFile = PHASE_TEXTURES[static_cast<std::size_t>(moon.phase)];
 
     if (!moonTexture.loadFromFile(moonImageFile)) {
         std::cerr << "Error: Could not load moon image from " << moonImageFile << std::endl;
@@ -248,12 +266,7 @@ void updateMoonDisplay(MoonInfo& moonInfo, sf::Texture& moonTexture, sf::Sprite&
         AppConfig::STAR_AREA_Y + (AppConfig::STAR_AREA_HEIGHT / 2.f)
     });
 
-    infoText.setString(
-        "Illumination: " + moonInfo.illumination + "%\n" +
-        "Phase: " + moonInfo.phase + "\n" +
-        "Moonrise: " + moonInfo.riseTimeString + "\n" +
-        "Moonset: " + moonInfo.setTimeString
-    );
+    infoText.setString(moonInfoText(moon));
 }
 
 enum class AppState {
@@ -379,27 +392,9 @@ int main() {
 
     MoonInfo moonInfo(lat, lng);
 
-    const std::map<std::string, std::string> phaseToFilename = {
-        {"New",             "assets/new_moon.png"},
-        {"Waxing Crescent", "assets/waxing_crescent.png"},
-        {"First Quarter",   "assets/first_quarter.png"},
-        {"Waxing Gibbous",  "assets/waxing_gibbous.png"},
-        {"Full Moon",            "assets/full_moon.png"},
-        {"Waning Gibbous",  "assets/waning_gibbous.png"},
-        {"Last Quarter",    "assets/last_quarter.png"},
-        {"Waning Crescent", "assets/waning_crescent.png"}
-    };
-
     sf::Texture moonTexture;
 
-    auto it = phaseToFilename.find(moonInfo.phase);
-    std::string moonImageFile;
-    if (it != phaseToFilename.end()) {
-        moonImageFile = it->second;
-    } else {
-        std::cerr << "Warning: Could not find image for phase: " << moonInfo.phase << ". Defaulting to new moon." << std::endl;
-        moonImageFile = "assets/new_moon.png"; 
-    }
+    std::string moonImageFile = PHASE_TEXTURES[static_cast<std::size_t>(moonInfo.result.phase)];
 
     if (!moonTexture.loadFromFile(moonImageFile)) {
         std::cerr << "Error: Could not load moon image from " << moonImageFile << std::endl;
@@ -425,11 +420,7 @@ int main() {
     std::vector<City> allCities = loadWorld();
 
     sf::Text text(font);
-    text.setString(
-        "Illumination: " + moonInfo.illumination + "%\n" +
-        "Phase: " + moonInfo.phase + "\n" +
-        "Moonrise: " + moonInfo.riseTimeString + "\n" +
-        "Moonset: " + moonInfo.setTimeString);
+    text.setString(moonInfoText(moonInfo.result));
     text.setCharacterSize(29);
     text.setFillColor(sf::Color::Yellow);
     text.setPosition({AppConfig::INFO_PANEL_X + 44, AppConfig::INFO_PANEL_Y + 9});
@@ -439,7 +430,7 @@ int main() {
 
     const sf::IntRect draggableArea({0, 0}, {AppConfig::FRAME_WIDTH, 60});
 
-    updateMoonDisplay(moonInfo, moonTexture, moonSprite, text, phaseToFilename);
+    updateMoonDisplay(moonInfo.result, moonTexture, moonSprite, text);
 
     sf::RectangleShape searchHighlight({286, 27.466});
     searchHighlight.setFillColor(sf::Color(251,65,65));
@@ -591,7 +582,7 @@ int main() {
                                         cityText.setPosition({200 - (textRect.size.x / 2), 76.5});
 
                                         moonInfo = MoonInfo(lat, lng);
-                                        updateMoonDisplay(moonInfo, moonTexture, moonSprite, text, phaseToFilename);
+                                        updateMoonDisplay(moonInfo.result, moonTexture, moonSprite, text);
                                         state = AppState::MainView;
 
                                         std::ofstream outFile("location.txt");
@@ -0,0 +1,503 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <ctime>
+
+#include <Almanac.cpp>
+#include <Apsides.cpp>
+#include <CelestialBody.cpp>
+#include <Eclipses.cpp>
+#include <MoonEvents.cpp>
+#include <MoonInfo.cpp>
+#include <Raster.cpp>
+#include <RiseSetEngine.cpp>
+
+namespace {
+
+void printUsage() {
+    std::cerr << "Usage:\n"
+              << "  tsuki-cli ephemeris <file> [start-year] [end-year]   Write a precomputed ephemeris (default 1900-2100)\n"
+              << "  tsuki-cli check-ephemeris <file>                     Validate a file and report its span and fit error\n"
+              << "  tsuki-cli interpolation-report [days]                Accuracy of interpolated lunar positions (default 30 days from now)\n"
+              << "  tsuki-cli scan-compare [years] [start-JD]            Check the adaptive horizon scan against the dense scan (default 4 years from J2000)\n"
+              << "  tsuki-cli rise-set [days] < observers                Moonrise/moonset (UTC) for \"latitude longitude\" lines on stdin\n"
+              << "  tsuki-cli raster altitude|moonrise|moonset <file> [resolution-deg] [hours-from-now]\n"
+              << "                                                       Global raster (.pgm image, otherwise raw float32)\n"
+              << "  tsuki-cli phases [start-year] [years]                New, quarter and full moon times (UTC, default this year)\n"
+              << "  tsuki-cli apsides [start-year] [years]               Perigees and apogees (UTC, km), flagging super- and micromoons\n"
+              << "  tsuki-cli eclipses [start-year] [years]              Lunar eclipses: greatest eclipse (UTC), type and magnitudes (default 10 years)\n"
+              << "  tsuki-cli info <latitude> <longitude> [YYYY-MM-DDTHH:MM]\n"
+              << "                                                       Phase, rise/set and transit as the app shows them, at a UTC time (default now)\n"
+              << "  tsuki-cli events <latitude> <longitude> [days]       Moonrise, moonset, transit and phase events (UTC, default 7 days)\n"
+              << "  tsuki-cli sun <latitude> <longitude> [days]          Sunrise, sunset and civil, nautical and astronomical twilight (UTC, default 1 day)\n"
+              << "  tsuki-cli almanac <latitude> <longitude> [days] [YYYY-MM-DD] [threads]\n"
+              << "                                                       Daily phase and local moonrise/moonset (default 365 days from today)\n";
+}
+
+double julianDayOfYear(int year) {
+    return toJulianDay(std::chrono::sys_days{std::chrono::year{year} / std::chrono::January / 1});
+}
+
+std::string formatUtc(double JD) {
+    auto utc = std::chrono::round<std::chrono::seconds>(fromJulianDay<std::chrono::milliseconds>(JD));
+    std::tm utc_tm = secondsToTm(utc.time_since_epoch().count());
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc_tm);
+    return buffer;
+}
+
+std::string formatLocalTime(double JD) {
+    std::tm local_tm = convertJdUtcToLocalTm(JD);
+    char buffer[8];
+    std::strftime(buffer, sizeof(buffer), "%H:%M", &local_tm);
+    return buffer;
+}
+
+int writeEphemeris(const std::vector<std::string>& args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+    int start_year = args.size() > 1 ? std::stoi(args[1]) : 1900;
+    int end_year = args.size() > 2 ? std::stoi(args[2]) : 2100;
+    if (!writeEphemerisFile(args[0], julianDayOfYear(start_year), julianDayOfYear(end_year + 1))) {
+        return 1;
+    }
+    std::cout << "Wrote " << args[0] << " covering " << start_year << "-" << end_year << std::endl;
+    return 0;
+}
+
+int checkEphemeris(const std::vector<std::string>& args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+    std::unique_ptr<EphemerisFile> file = EphemerisFile::open(args[0]);
+    if (!file) {
+        return 1;
+    }
+
+    double max_longitude = 0.0;
+    double max_latitude = 0.0;
+    double max_distance = 0.0;
+    double max_solar = 0.0;
+    for (double JD = file->startJD(); JD < file->endJD(); JD += 0.37) {
+        EphemerisFileSegment segment = file->segment(JD);
+        LunarCoords moon = EphemerisCache::lunarAt(*segment.coefficients, segment.x);
+        LunarCoords moon_series = getLunarCoordinates<LunarPrecision::Full>(JD);
+        SolarCoords sun = EphemerisCache::solarAt(*segment.coefficients, segment.x);
+        SolarCoords sun_series = getSolarCoordinates(JD);
+
+        max_longitude = std::max(max_longitude, std::abs(remainder(moon.eclipticLongitude - moon_series.eclipticLongitude, 360.0)));
+        max_latitude = std::max(max_latitude, std::abs(moon.eclipticLatitude - moon_series.eclipticLatitude));
+        max_distance = std::max(max_distance, std::abs(moon.radiusVector - moon_series.radiusVector));
+        max_solar = std::max(max_solar, std::abs(remainder(sun.eclipticLongitude - sun_series.eclipticLongitude, 360.0)));
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "Span: JD " << file->startJD() << " - " << file->endJD() << "\n"
+              << std::scientific << std::setprecision(2)
+              << "Max deviation from the series: lunar longitude " << max_longitude * 3600.0
+              << "\", latitude " << max_latitude * 3600.0
+              << "\", distance " << max_distance
+              << " km, solar longitude " << max_solar * 3600.0 << "\"" << std::endl;
+    return 0;
+}
+
+int interpolationReport(const std::vector<std::string>& args) {
+    double days = args.empty() ? 30.0 : std::stod(args[0]);
+    double start_JD = currentJulianDay();
+
+    std::cout << "Step      Samples/48h   RA (\")      Dec (\")     Distance (km)  Separation (\")\n";
+    for (double step_hours : {0.5, 1.0, 2.0, 3.0, 6.0}) {
+        double step_days = step_hours / 24.0;
+        InterpolationAccuracy accuracy = interpolationAccuracy(start_JD, start_JD + days, step_days);
+        std::size_t samples = LunarTrack(start_JD, start_JD + 2.0, step_days).sampleCount();
+        std::cout << std::fixed << std::setprecision(1) << std::setw(4) << step_hours << " h    "
+                  << std::setw(6) << samples << "        "
+                  << std::scientific << std::setprecision(2)
+                  << std::setw(10) << accuracy.maxRightAscensionArcsec << "   "
+                  << std::setw(10) << accuracy.maxDeclinationArcsec << "   "
+                  << std::setw(10) << accuracy.maxDistanceKm << "     "
+                  << std::setw(10) << accuracy.maxSeparationArcsec << "\n";
+    }
+    std::cout << "Direct scan: 577 samples/48h plus refinement." << std::endl;
+    return 0;
+}
+
+// Every dense-scan event must have an adaptive-scan event within `tolerance`, and vice versa.
+int countUnmatched(const std::vector<double>& expected, const std::vector<double>& found, double tolerance, double& max_difference) {
+    int unmatched = 0;
+    for (double JD : expected) {
+        auto it = std::lower_bound(found.begin(), found.end(), JD);
+        double nearest = std::numeric_limits<double>::infinity();
+        if (it != found.end()) {
+            nearest = std::min(nearest, std::abs(*it - JD));
+        }
+        if (it != found.begin()) {
+            nearest = std::min(nearest, std::abs(*(it - 1) - JD));
+        }
+        if (nearest > tolerance) {
+            ++unmatched;
+        } else {
+            max_difference = std::max(max_difference, nearest);
+        }
+    }
+    return unmatched;
+}
+
+int scanCompare(const std::vector<std::string>& args) {
+    double years = args.empty() ? 4.0 : std::stod(args[0]);
+    double start_JD = args.size() > 1 ? std::stod(args[1]) : JD_2000_0;
+    double end_JD = start_JD + years * 365.25;
+    const double MATCH_TOLERANCE_JD = 2.0 / (24.0 * 60.0 * 60.0);
+
+    LunarTrack track(start_JD, end_JD);
+    long long dense_evaluations = 0;
+    long long adaptive_evaluations = 0;
+    long long events = 0;
+    int failures = 0;
+    double max_difference = 0.0;
+
+    std::cout << std::fixed << std::setprecision(1) << "Interval: JD " << start_JD << " - " << end_JD << "\n"
+              << "Latitude  Events  Missed  Extra\n";
+    for (double latitude = -85.0; latitude <= 85.0; latitude += 5.0) {
+        long long latitude_events = 0;
+        int missed = 0;
+        int extra = 0;
+        for (double longitude : {-120.0, 0.0, 135.0}) {
+            auto altitude = [&](double JD) {
+                return getTopocentricAltitude(track.at(JD), JD, longitude, latitude);
+            };
+            HorizonCrossings dense = findHorizonCrossings(altitude, start_JD, end_JD, HORIZON_ALT_DEG, HorizonScan::Dense);
+            HorizonCrossings adaptive = findHorizonCrossings(altitude, start_JD, end_JD, HORIZON_ALT_DEG, HorizonScan::Adaptive);
+
+            missed += countUnmatched(dense.rises, adaptive.rises, MATCH_TOLERANCE_JD, max_difference);
+            missed += countUnmatched(dense.sets, adaptive.sets, MATCH_TOLERANCE_JD, max_difference);
+            extra += countUnmatched(adaptive.rises, dense.rises, MATCH_TOLERANCE_JD, max_difference);
+            extra += countUnmatched(adaptive.sets, dense.sets, MATCH_TOLERANCE_JD, max_difference);
+
+            latitude_events += static_cast<long long>(dense.rises.size() + dense.sets.size());
+            dense_evaluations += dense.evaluations;
+            adaptive_evaluations += adaptive.evaluations;
+        }
+        events += latitude_events;
+        failures += missed + extra;
+        std::cout << std::fixed << std::setprecision(0) << std::setw(8) << latitude << "  "
+                  << std::setw(6) << latitude_events << "  " << std::setw(6) << missed << "  " << std::setw(5) << extra << "\n";
+    }
+
+    std::cout << std::setprecision(2)
+              << events << " events, " << failures << " mismatches, max time difference "
+              << max_difference * 86400.0 << " s\n"
+              << "Altitude evaluations: dense " << dense_evaluations << ", adaptive " << adaptive_evaluations
+              << " (" << static_cast<double>(dense_evaluations) / static_cast<double>(adaptive_evaluations) << "x fewer)" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+
+int raster(const std::vector<std::string>& args) {
+    if (args.size() < 2) {
+        printUsage();
+        return 1;
+    }
+    const std::string& kind = args[0];
+    const std::string& path = args[1];
+    RasterGrid grid{args.size() > 2 ? std::stod(args[2]) : 0.25};
+    double JD = currentJulianDay() + (args.size() > 3 ? std::stod(args[3]) / 24.0 : 0.0);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<float> values;
+    double min_value, max_value;
+    if (kind == "altitude") {
+        values = altitudeRaster(grid, JD);
+        min_value = -90.0;
+        max_value = 90.0;
+    } else if (kind == "moonrise" || kind == "moonset") {
+        RiseSetRaster rise_set = riseSetRaster(grid, JD);
+        values = kind == "moonrise" ? std::move(rise_set.riseHours) : std::move(rise_set.setHours);
+        min_value = 0.0;
+        max_value = 24.0;
+    } else {
+        printUsage();
+        return 1;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!writeRaster(path, grid, values, min_value, max_value)) {
+        return 1;
+    }
+    std::cout << "Wrote " << grid.width() << "x" << grid.height() << " " << kind << " raster to " << path
+              << " in " << std::fixed << std::setprecision(2) << elapsed << " s" << std::endl;
+    return 0;
+}
+
+int almanac(const std::vector<std::string>& args) {
+    if (args.size() < 2) {
+        printUsage();
+        return 1;
+    }
+    double latitude = std::stod(args[0]);
+    double longitude = std::stod(args[1]);
+    int days = args.size() > 2 ? std::stoi(args[2]) : 365;
+
+    std::tm start_tm = convertJdUtcToLocalTm(currentJulianDay());
+    int year = start_tm.tm_year + 1900;
+    int month = start_tm.tm_mon + 1;
+    int day = start_tm.tm_mday;
+    if (args.size() > 3 && std::sscanf(args[3].c_str(), "%d-%d-%d", &year, &month, &day) != 3) {
+        printUsage();
+        return 1;
+    }
+    unsigned threads = args.size() > 4 ? static_cast<unsigned>(std::stoul(args[4])) : 0;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<AlmanacDay> entries = generateAlmanac(latitude, longitude, year, month, day, days, threads);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    auto event = [](const std::optional<double>& JD, HorizonClass no_event_class) -> std::string {
+        if (JD) {
+            return formatLocalTime(*JD);
+        }
+        switch (no_event_class) {
+            case HorizonClass::AlwaysAbove:
+                return "above";
+            case HorizonClass::AlwaysBelow:
+                return "below";
+            default:
+                return "--:--";
+        }
+    };
+
+    std::cout << "Date        Phase            Illum   Rise   Set\n";
+    for (const AlmanacDay& entry : entries) {
+        char date[16];
+        std::snprintf(date, sizeof(date), "%04d-%02d-%02d", entry.year, entry.month, entry.day);
+        std::cout << date << "  " << std::left << std::setw(15) << lunarPhaseName(entry.phase.phase) << std::right << "  "
+                  << std::fixed << std::setprecision(1) << std::setw(5) << entry.phase.illuminatedFraction * 100.0 << "%  "
+                  << std::setw(5) << event(entry.riseJD, entry.noEventClass) << "  "
+                  << std::setw(5) << event(entry.setJD, entry.noEventClass) << "\n";
+    }
+    std::cerr << entries.size() << " days in " << std::setprecision(3) << elapsed << " s" << std::endl;
+    return 0;
+}
+
+int phases(const std::vector<std::string>& args) {
+    int start_year = args.empty() ? convertJdUtcToLocalTm(currentJulianDay()).tm_year + 1900 : std::stoi(args[0]);
+    int years = args.size() > 1 ? std::stoi(args[1]) : 1;
+
+    for (const PhaseEvent& event : findPhaseEvents(julianDayOfYear(start_year), julianDayOfYear(start_year + years))) {
+        std::cout << formatUtc(event.JD) << "  " << principalPhaseName(event.phase) << "\n";
+    }
+    return 0;
+}
+
+int apsides(const std::vector<std::string>& args) {
+    int start_year = args.empty() ? convertJdUtcToLocalTm(currentJulianDay()).tm_year + 1900 : std::stoi(args[0]);
+    int years = args.size() > 1 ? std::stoi(args[1]) : 1;
+
+    for (const ApsisEvent& event : findApsides(julianDayOfYear(start_year), julianDayOfYear(start_year + years))) {
+        std::cout << formatUtc(event.JD) << "  " << (event.apsis == Apsis::Perigee ? "Perigee" : "Apogee ")
+                  << std::fixed << std::setprecision(0) << std::setw(8) << event.distance << " km";
+        if (event.fullMoonJD) {
+            std::cout << (event.apsis == Apsis::Perigee ? "  supermoon " : "  micromoon ") << formatUtc(*event.fullMoonJD);
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
+
+int eclipses(const std::vector<std::string>& args) {
+    int start_year = args.empty() ? convertJdUtcToLocalTm(currentJulianDay()).tm_year + 1900 : std::stoi(args[0]);
+    int years = args.size() > 1 ? std::stoi(args[1]) : 10;
+
+    std::cout << "Greatest eclipse      Type       Umbral  Penumbral\n";
+    for (const LunarEclipse& eclipse : findLunarEclipses(julianDayOfYear(start_year), julianDayOfYear(start_year + years))) {
+        const char* type = eclipse.type == LunarEclipseType::Total     ? "Total    "
+                           : eclipse.type == LunarEclipseType::Partial ? "Partial  "
+                                                                       : "Penumbral";
+        std::cout << formatUtc(eclipse.greatestJD) << "  " << type << "  " << std::fixed << std::setprecision(3)
+                  << std::setw(6) << eclipse.umbralMagnitude << "  " << std::setw(9) << eclipse.penumbralMagnitude << "\n";
+    }
+    return 0;
+}
+
+int info(const std::vector<std::string>& args) {
+    if (args.size() < 2) {
+        printUsage();
+        return 1;
+    }
+    ObserverSite site = makeObserverSite(std::stod(args[0]), std::stod(args[1]));
+    std::chrono::sys_seconds time = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+    if (args.size() > 2) {
+        int year, month, day, hour, minute;
+        if (std::sscanf(args[2].c_str(), "%d-%d-%dT%d:%d", &year, &month, &day, &hour, &minute) != 5) {
+            printUsage();
+            return 1;
+        }
+        time = std::chrono::sys_days{std::chrono::year{year} / month / day} + std::chrono::hours{hour} + std::chrono::minutes{minute};
+    }
+
+    MoonInfoResult moon = MoonInfo(time, site).result;
+    char buffer[32];
+    auto text = [&](std::to_chars_result formatted) {
+        return std::string_view(buffer, static_cast<std::size_t>(formatted.ptr - buffer));
+    };
+    auto degrees = [&](const std::optional<double>& value) {
+        return value ? text(formatDegrees(buffer, std::end(buffer), *value)) : std::string_view("N/A");
+    };
+    std::cout << "Phase:        " << lunarPhaseName(moon.phase) << " (" << text(formatIllumination(buffer, std::end(buffer), moon.illuminatedFraction)) << "%)\n";
+    std::cout << "Rise:         " << text(formatMoonrise(buffer, std::end(buffer), moon)) << " (azimuth " << degrees(moon.riseAzimuth) << ")\n";
+    std::cout << "Set:          " << text(formatMoonset(buffer, std::end(buffer), moon)) << " (azimuth " << degrees(moon.setAzimuth) << ")\n";
+    std::cout << "Transit:      " << text(formatEventTime(buffer, std::end(buffer), moon.transitJD)) << " (altitude " << degrees(moon.maxAltitude) << ")\n";
+    return 0;
+}
+
+int events(const std::vector<std::string>& args) {
+    if (args.size() < 2) {
+        printUsage();
+        return 1;
+    }
+    ObserverSite observer = makeObserverSite(std::stod(args[0]), std::stod(args[1]));
+    double days = args.size() > 2 ? std::stod(args[2]) : 7.0;
+    double start_JD = currentJulianDay();
+
+    for (const MoonEvent& event : moonEvents(observer, start_JD, start_JD + days)) {
+        std::cout << formatUtc(event.JD) << "  " << moonEventName(event.type) << "\n";
+    }
+    return 0;
+}
+
+int sun(const std::vector<std::string>& args) {
+    if (args.size() < 2) {
+        printUsage();
+        return 1;
+    }
+    double latitude = std::stod(args[0]);
+    double longitude = std::stod(args[1]);
+    double days = args.size() > 2 ? std::stod(args[2]) : 1.0;
+    double start_JD = currentJulianDay();
+
+    const char* const RISE_NAMES[] = {"Sunrise", "Civil dawn", "Nautical dawn", "Astronomical dawn"};
+    const char* const SET_NAMES[] = {"Sunset", "Civil dusk", "Nautical dusk", "Astronomical dusk"};
+
+    std::array<HorizonCrossings, 4> crossings = findSolarEvents(longitude, latitude, start_JD, start_JD + days);
+    std::vector<std::pair<double, const char*>> events;
+    for (std::size_t i = 0; i < crossings.size(); ++i) {
+        for (double JD : crossings[i].rises) {
+            events.emplace_back(JD, RISE_NAMES[i]);
+        }
+        for (double JD : crossings[i].sets) {
+            events.emplace_back(JD, SET_NAMES[i]);
+        }
+    }
+    std::sort(events.begin(), events.end());
+
+    for (const auto& [JD, name] : events) {
+        std::cout << formatUtc(JD) << "  " << name << "\n";
+    }
+    return 0;
+}
+
+int riseSet(const std::vector<std::string>& args) {
+    double days = args.empty() ? 1.0 : std::stod(args[0]);
+    double start_JD = currentJulianDay();
+
+    std::vector<ObserverSite> observers;
+    double latitude, longitude;
+    while (std::cin >> latitude >> longitude) {
+        observers.push_back(makeObserverSite(latitude, longitude));
+    }
+
+    RiseSetEngine engine(start_JD, start_JD + days);
+    std::vector<RiseSetResult> results = engine.compute(observers);
+
+    for (std::size_t i = 0; i < observers.size(); ++i) {
+        std::cout << observers[i].latitude << " " << observers[i].longitude;
+        switch (results[i].horizonClass) {
+            case HorizonClass::AlwaysAbove:
+                std::cout << " always-above";
+                break;
+            case HorizonClass::AlwaysBelow:
+                std::cout << " always-below";
+                break;
+            default:
+                for (double JD : results[i].crossings.rises) {
+                    std::cout << " rise=" << formatUtc(JD);
+                }
+                for (double JD : results[i].crossings.sets) {
+                    std::cout << " set=" << formatUtc(JD);
+                }
+                break;
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+
+    std::string command = argv[1];
+    std::vector<std::string> args(argv + 2, argv + argc);
+
+    try {
+        if (command == "ephemeris") {
+            return writeEphemeris(args);
+        }
+        if (command == "check-ephemeris") {
+            return checkEphemeris(args);
+        }
+        if (command == "interpolation-report") {
+            return interpolationReport(args);
+        }
+        if (command == "scan-compare") {
+            return scanCompare(args);
+        }
+        if (command == "rise-set") {
+            return riseSet(args);
+        }
+        if (command == "raster") {
+            return raster(args);
+        }
+        if (command == "phases") {
+            return phases(args);
+        }
+        if (command == "apsides") {
+            return apsides(args);
+        }
+        if (command == "eclipses") {
+            return eclipses(args);
+        }
+        if (command == "info") {
+            return info(args);
+        }
+        if (command == "events") {
+            return events(args);
+        }
+        if (command == "sun") {
+            return sun(args);
+        }
+        if (command == "almanac") {
+            return almanac(args);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    printUsage();
+    return 1;
+}